@@ -64,6 +64,10 @@ int Graph::getNumVertices() const {
     return numVertices;                        
 }
 
+bool Graph::isDirected() const {
+    return directed;
+}
+
 // Depth-First Search helper function to mark all reachable vertices
 void Graph::dfs(int v, vector<bool>& visited, const vector<vector<int>>& localAdjList) const {
     visited[v] = true; // Mark the current vertex as visited
@@ -19,6 +19,7 @@ public:
 
     const vector<int>& getNeighbors(int v) const; // Return neighbors of vertex v
     int getNumVertices() const;  // Return total vertices
+    bool isDirected() const; // Whether edges are one-way
 
     bool hasEulerCircuit() const;// Check if Euler circuit exists
     vector<int> findEulerCircuit(int start = 0); // Return Euler circuit starting from given vertex
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+
+// Binary CSR graph file, little-endian as written by the host, every section 8-byte aligned:
+//   header (64 bytes, GraphFileHeader)
+//   offsets  uint64[numVertices + 1]   arcs of v are [offsets[v], offsets[v+1])
+//   targets  uint32[numArcs]           sorted within each vertex, padded to 8 bytes
+//   weights  int32[numArcs]            only when FLAG_WEIGHTED, padded to 8 bytes
+// An undirected edge is stored as two arcs. The checksum covers everything after the header.
+struct GraphFileHeader {
+    static constexpr char MAGIC[8] = {'G', 'R', 'A', 'P', 'H', 'C', 'S', 'R'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t FLAG_DIRECTED = 1, FLAG_WEIGHTED = 2;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    uint64_t numVertices;
+    uint64_t numArcs;
+    uint64_t offsetsPos; // Byte positions of the sections in the file
+    uint64_t targetsPos;
+    uint64_t weightsPos; // 0 without weights
+    uint64_t checksum;
+};
+static_assert(sizeof(GraphFileHeader) == 64, "GraphFileHeader must stay 64 bytes");
+
+// Write g as a graph file, 'weights' (optional) holds one weight per arc in file order:
+// vertex by vertex, neighbors ascending. Throws system_error if the file can't be written.
+void writeGraphFile(const std::string& path, const Graph& g, const std::vector<int32_t>* weights = nullptr);
+
+// Read-only CSR view of a graph file mapped with mmap: nothing is parsed or copied, pages are
+// loaded by the kernel on first touch. With 'verify' the checksum and the CSR invariants
+// (monotone offsets, targets in range) are checked once at open, costing one pass over the file;
+// without it only the header is checked and the contents are trusted.
+class MappedGraph {
+public:
+    explicit MappedGraph(const std::string& path, bool verify = true);
+    ~MappedGraph();
+    MappedGraph(MappedGraph&& other) noexcept;
+    MappedGraph& operator=(MappedGraph&& other) noexcept;
+    MappedGraph(const MappedGraph&) = delete;
+    MappedGraph& operator=(const MappedGraph&) = delete;
+
+    int getNumVertices() const { return static_cast<int>(header().numVertices); }
+    bool isDirected() const { return header().flags & GraphFileHeader::FLAG_DIRECTED; }
+    bool hasWeights() const { return header().flags & GraphFileHeader::FLAG_WEIGHTED; }
+    uint64_t getNumArcs() const { return header().numArcs; }
+    int degree(int v) const { return static_cast<int>(offsets()[v + 1] - offsets()[v]); }
+    // Neighbors of v as a [first, last) range into the mapping
+    std::pair<const uint32_t*, const uint32_t*> neighbors(int v) const {
+        return {targets() + offsets()[v], targets() + offsets()[v + 1]};
+    }
+    const uint64_t* offsets() const { return reinterpret_cast<const uint64_t*>(base + header().offsetsPos); }
+    const uint32_t* targets() const { return reinterpret_cast<const uint32_t*>(base + header().targetsPos); }
+    const int32_t* weights() const { // nullptr without weights
+        return hasWeights() ? reinterpret_cast<const int32_t*>(base + header().weightsPos) : nullptr;
+    }
+
+    Graph toGraph() const; // Mutable Graph for the algorithms
+
+private:
+    const char* base = nullptr;
+    size_t size = 0;
+
+    const GraphFileHeader& header() const { return *reinterpret_cast<const GraphFileHeader*>(base); }
+    void validate(bool verify) const;
+    void unmap();
+};
@@ -4,6 +4,7 @@
 #include <vector>
 #include <algorithm>
 #include "main.hpp"
+#include "graph_file.hpp"
 using namespace std;
 
 extern char *optarg;   //holds the option argument
@@ -55,19 +56,30 @@ Graph buildRandGraph(int numOfEdges, int numOfVartx, int seed){
 
 #ifndef UNIT_TESTING
 int main(int argc, char* argv[]) {
-    //Usage check: expects -e <edges> -v <vertices> -s <seed>
-    if(argc < 7){
-        cout << "Please enter 'program name' -e <numberOfEdges> -v <numberOfVertax> -s <seed>" << endl;
+    //Usage check: expects -e <edges> -v <vertices> -s <seed>, or -f <graph file>
+    const char* usage = "Please enter 'program name' -e <numberOfEdges> -v <numberOfVertax> -s <seed> [-o <graph file to save>]\n"
+                        "or 'program name' -f <graph file>";
+    if(argc < 3){
+        cout << usage << endl;
         return 1;
     }
     int numOfEdges = 0;
     int numOfVartx = 0;
     int seed;
     int ret;
+    string inFile, outFile;
 
     //Get the arguments from the user and cheack correctness
-    while((ret = getopt(argc, argv, ":e:v:s:")) != -1){
+    while((ret = getopt(argc, argv, ":f:o:e:v:s:")) != -1){
         switch(ret){
+            //Binary graph file (see graph_file.hpp) to load instead of a random graph
+            case 'f':
+                inFile = optarg;
+                break;
+            //Save the random graph as a binary graph file
+            case 'o':
+                outFile = optarg;
+                break;
             //Unknown option
             case '?':
                 std::cout << static_cast<char>(optopt) << " is unknown option" << std::endl;
@@ -85,7 +97,19 @@ int main(int argc, char* argv[]) {
                 }catch(const std::invalid_argument&){printf("invalid argument, write number(int) for seed\n"); return 1; }
         }
     }
-    Graph graph = buildRandGraph(numOfEdges, numOfVartx, seed); 
+    if(inFile.empty() && argc < 7){
+        cout << usage << endl;
+        return 1;
+    }
+    Graph graph(0);
+    try{
+        //A mapped file is read in place, no text parsing
+        graph = inFile.empty() ? buildRandGraph(numOfEdges, numOfVartx, seed) : MappedGraph(inFile).toGraph();
+        if(!outFile.empty()) writeGraphFile(outFile, graph);
+    }catch(const std::exception& e){
+        cout << e.what() << endl;
+        return 1;
+    }
     // Print the graph
     graph.printGraph();
     // Check if the graph has an Euler circuit; if so, compute and print it
@@ -1,6 +1,8 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "graph.hpp"
+#include "graph_file.hpp"
+#include <cstdio>
 #include <vector>
 
 TEST_CASE("addEdge"){
@@ -129,4 +131,22 @@ TEST_CASE("removeAllEdges"){
     CHECK(g.getNeighbors(1) == expect);
     CHECK(g.getNeighbors(2) == expect);
     CHECK(g.getNeighbors(3) == expect);
-}
\ No newline at end of file
+}
+
+TEST_CASE("graph file round trip"){
+    Graph g(5, false);
+    g.addEdge(0,1);
+    g.addEdge(1,2);
+    g.addEdge(2,0);
+    g.addEdge(3,4);
+    writeGraphFile("test_graph.csr", g);
+    MappedGraph m("test_graph.csr");
+    CHECK_EQ(m.getNumVertices(), 5);
+    CHECK_FALSE(m.isDirected());
+    CHECK_EQ(m.getNumArcs(), 8u);
+    Graph back = m.toGraph();
+    for (int v = 0; v < 5; ++v) CHECK_EQ(back.getNeighbors(v).size(), g.getNeighbors(v).size());
+    CHECK_EQ(back.hasEulerCircuit(), g.hasEulerCircuit());
+    std::remove("test_graph.csr");
+    CHECK_THROWS(MappedGraph{"test_graph.csr"});
+}
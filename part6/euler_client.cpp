@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <cstring>
+#include <cerrno>
 #include <unistd.h>
 #include <arpa/inet.h>
 
@@ -53,12 +54,24 @@ int main() {
 
     string data_to_send = graph_data.str();
 
-    //Send the graph data to the server
-    send(sock, data_to_send.c_str(), data_to_send.size(), 0);
+    //Send the graph data to the server, then close our side so it knows the graph is complete
+    const char* p = data_to_send.c_str();
+    size_t left = data_to_send.size();
+    while (left > 0) {
+        ssize_t w = send(sock, p, left, 0);
+        if (w < 0) { if (errno == EINTR) continue; perror("Send failed"); return 1; }
+        p += w;
+        left -= (size_t)w;
+    }
+    shutdown(sock, SHUT_WR);
 
-    // Read the response
-    read(sock, buffer, BUFFER_SIZE);
-    cout << "Server response: " << buffer << endl;
+    // Read the response, it arrives in chunks until the server closes the connection
+    cout << "Server response: ";
+    ssize_t n;
+    while ((n = read(sock, buffer, BUFFER_SIZE)) > 0) {
+        cout.write(buffer, n);
+    }
+    cout << endl;
 
     //Close the socket
     close(sock);
@@ -0,0 +1,106 @@
+#ifndef EULER_IO_H
+#define EULER_IO_H
+
+#include <charconv>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/socket.h>
+#include "graph.hpp"
+
+//Socket output and request parsing of euler_server, kept in a header so the tests can drive them over a socketpair
+
+#define CHUNK_SIZE 65536 //Size of one response chunk sent to the client
+
+//Sends all n bytes, retrying on partial sends
+inline bool send_all(int fd, const char* p, size_t n) {
+    while (n > 0) {
+        ssize_t w = send(fd, p, n, 0);
+        if (w < 0) { if (errno == EINTR) continue; return false; }
+        p += w;
+        n -= (size_t)w;
+    }
+    return true;
+}
+
+//Writes circuit vertices as text into a fixed buffer and sends it to the client whenever it fills up
+class SocketSink : public EulerSink {
+public:
+    explicit SocketSink(int fd) : fd(fd) {}
+
+    void emit(int v) override {
+        if (used + 12 > CHUNK_SIZE) flush(); //room for "-2147483648 "
+        char* end = to_chars(chunk + used, chunk + CHUNK_SIZE, v).ptr;
+        *end++ = ' ';
+        used = end - chunk;
+    }
+
+    void finish(bool reversed) override {
+        if (reversed) append("\n(reversed)"); //vertices were sent from the end of the circuit back to its start
+        flush();
+    }
+
+    void append(const string& text) {
+        if (used + text.size() > CHUNK_SIZE) flush();
+        memcpy(chunk + used, text.data(), text.size());
+        used += text.size();
+    }
+
+    void flush() {
+        if (used > 0 && ok) ok = send_all(fd, chunk, used);
+        used = 0;
+    }
+
+private:
+    int fd;
+    char chunk[CHUNK_SIZE];
+    size_t used = 0;
+    bool ok = true; //false once the client went away
+};
+
+//Reads the request text chunk by chunk: the number of vertices, then "u v" pairs.
+//Numbers are read with from_chars, a number cut by the end of a chunk waits for the next one.
+//Like the old stream extraction, parsing stops at the first token that is not a number.
+class GraphParser {
+public:
+    void feed(const char* p, const char* end, bool last) {
+        if (bad) return;
+        if (!carry.empty()) { //finish the number cut by the previous chunk
+            while (p < end && !isspace((unsigned char)*p)) carry += *p++;
+            if (p == end && !last) return;
+            number(carry.data(), carry.data() + carry.size());
+            carry.clear();
+        }
+        while (!bad) {
+            while (p < end && isspace((unsigned char)*p)) ++p;
+            if (p == end) return;
+            const char* start = p;
+            while (p < end && !isspace((unsigned char)*p)) ++p;
+            if (p == end && !last) { carry.assign(start, end); return; }
+            number(start, p);
+        }
+    }
+
+    int numVertices = 0;
+    vector<pair<int, int>> edges;
+
+private:
+    string carry; //start of a number that continues in the next chunk
+    bool bad = false; //a token failed to parse, the rest is ignored
+    bool haveVertices = false;
+    bool haveU = false;
+    int u = 0;
+
+    void number(const char* b, const char* e) {
+        int x;
+        auto [ptr, ec] = from_chars(b, e, x);
+        if (ec != errc() || ptr != e) { bad = true; return; }
+        if (!haveVertices) { numVertices = x; haveVertices = true; }
+        else if (!haveU) { u = x; haveU = true; }
+        else { edges.push_back({u, x}); haveU = false; }
+    }
+};
+
+#endif
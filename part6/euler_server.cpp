@@ -2,11 +2,17 @@
 #include <cstring>
 #include <unistd.h>
 #include <arpa/inet.h>
-#include <sstream>
+#include <charconv>
+#include <memory>
+#include <cerrno>
+#include <cctype>
+#include <string>
+#include <vector>
 #include "graph.hpp"
+#include "euler_io.hpp"
 
 #define PORT 8080
-#define BUFFER_SIZE 4096
+#define BUFFER_SIZE 65536 //Bytes read from the client per read() call
 
 using namespace std;
 
@@ -14,7 +20,7 @@ int main() {
     int server_fd, client_fd;
     struct sockaddr_in server_addr, client_addr;
     socklen_t addr_len = sizeof(client_addr);
-    char buffer[BUFFER_SIZE] = {0};
+    static char buffer[BUFFER_SIZE];
 
     //Create socket
     server_fd = socket(AF_INET, SOCK_STREAM, 0);
@@ -51,36 +57,38 @@ int main() {
 
     cout << "Client connected!\n";
 
-    //Read data from client
-    read(client_fd, buffer, BUFFER_SIZE);
-    cout << "Received:\n" << buffer << endl;
-
-    //first line = number of vertices
-    //Remaining lines: one edge per line: u v
-    istringstream iss(buffer); //create a stream from the received buffer
-    int numVertices;
-    iss >> numVertices; //read number of vertices
+    //Read data from client until it closes its side, parsing every chunk as it arrives
+    GraphParser parser;
+    ssize_t n;
+    while ((n = read(client_fd, buffer, BUFFER_SIZE)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        parser.feed(buffer, buffer + n, false);
+    }
+    parser.feed(buffer, buffer, true); //a number at the very end has no whitespace after it
+    cout << "Received graph: " << parser.numVertices << " vertices, " << parser.edges.size() << " edges" << endl;
 
-    Graph g(numVertices, false); //create an undirected graph with that many vertices
-    int u, v;
-    while (iss >> u >> v) {  //read edges until input ends
+    //first number = number of vertices, then one edge per pair: u v
+    Graph g(parser.numVertices, false); //create an undirected graph with that many vertices
+    for (const auto& [u, v] : parser.edges) { //addEdge is O(1) here, no duplicate scan
         g.addEdge(u, v);
     }
-
-    //Process the graph
-    string response;
-    if (g.hasEulerCircuit()) {
-        vector<int> circuit = g.findEulerCircuit();
-        response = "Euler Circuit: ";
-        for (int node : circuit) {
-            response += to_string(node) + " ";
-        }
+    vector<pair<int, int>>().swap(parser.edges);
+
+    //Process the graph, the circuit is streamed to the client in chunks as it is built
+    //The circuit starts at the first vertex with edges, a graph without edges has none
+    int start = 0;
+    while (start < g.getNumVertices() && g.getNeighbors(start).empty()) ++start;
+    if (start < g.getNumVertices() && g.hasEulerCircuit()) {
+        auto sink = make_unique<SocketSink>(client_fd); //chunk buffer lives on the heap
+        sink->append("Euler Circuit: ");
+        g.streamEulerCircuit(*sink, start);
     } else {
-        response = "No Euler Circuit";
+        string response = "No Euler Circuit";
+        send_all(client_fd, response.c_str(), response.length());
     }
-
-    // Send response to client
-    send(client_fd, response.c_str(), response.length(), 0);
     cout << "Result sent to client.\n";
 
     // Close connection
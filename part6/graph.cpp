@@ -7,7 +7,8 @@
 Graph::Graph(int vertices, bool directed) 
     : numVertices(vertices),  
       directed(directed),        
-      adjList(vertices) {}       
+      adjList(vertices),
+      edgeIdList(vertices) {}       
 
 // Function to add an edge between two vertices u and v
 void Graph::addEdge(int u, int v) {
@@ -15,29 +16,53 @@ void Graph::addEdge(int u, int v) {
         std::cout << "Error: Invalid vertex index." << std::endl;  // Print error if they are out of range
         return;                                                   
     }
+    int id = edgeEnds.size(); // Every added edge gets its own id, parallel edges included
+    edgeEnds.push_back({u, v});
     adjList[u].push_back(v); // Add v to u's adjacency list
+    edgeIdList[u].push_back(id);
     if (!directed) { // If the graph is undirected
         adjList[v].push_back(u);// Add u to v's adjacency list as well
+        edgeIdList[v].push_back(id);// Both directions share one id
     }
 }
 
+// Erase the slot of u's list that holds edge 'id'
+static void eraseEdgeSlot(vector<int>& neighbors, vector<int>& ids, int id) {
+    auto it = std::find(ids.begin(), ids.end(), id);
+    if (it == ids.end()) return;
+    neighbors.erase(neighbors.begin() + (it - ids.begin()));
+    ids.erase(it);
+}
+
+// Keep ids dense: the last id takes over the slot of the removed one
+void Graph::releaseEdgeId(int id) {
+    int last = edgeEnds.size() - 1;
+    if (id != last) {
+        auto [a, b] = edgeEnds[last];
+        edgeEnds[id] = edgeEnds[last];
+        for (int& e : edgeIdList[a]) if (e == last) e = id;
+        for (int& e : edgeIdList[b]) if (e == last) e = id;
+    }
+    edgeEnds.pop_back();
+}
+
 // Function to remove an edge between two vertices u and v
 void Graph::removeEdge(int u, int v) {
     if (u < 0 || u >= numVertices || v < 0 || v >= numVertices) {  // Check if u and v are valid indices
         std::cout << "Error: Invalid vertex index." << std::endl;  
         return;                                                
     }
-    auto& neighborsU = adjList[u]; // Reference to u's adjacency list
-    neighborsU.erase(                                              
-        std::remove(neighborsU.begin(), neighborsU.end(), v), // Find v in u's list and move it to the end
-        neighborsU.end() // Erase the found element(s)
-    );
-    if (!directed) {  // If the graph is undirected
-        auto& neighborsV = adjList[v]; // Reference to v's adjacency list
-        neighborsV.erase(                                          
-            std::remove(neighborsV.begin(), neighborsV.end(), u),  // Find u in v's list and move it to the end
-            neighborsV.end() // Erase the found element(s)
-        );
+    // Remove every (parallel) copy of the edge
+    for (;;) {
+        auto& neighborsU = adjList[u]; // Reference to u's adjacency list
+        auto it = std::find(neighborsU.begin(), neighborsU.end(), v); // Find v in u's list
+        if (it == neighborsU.end()) break;
+        int id = edgeIdList[u][it - neighborsU.begin()];
+        eraseEdgeSlot(neighborsU, edgeIdList[u], id);
+        if (!directed) {  // If the graph is undirected
+            eraseEdgeSlot(adjList[v], edgeIdList[v], id); // Erase the matching slot in v's list
+        }
+        releaseEdgeId(id);
     }
 }
 
@@ -62,15 +87,20 @@ int Graph::getNumVertices() const {
     return numVertices;                        
 }
 
-// Depth-First Search helper function to mark all reachable vertices
+// Depth-First Search helper function to mark all reachable vertices.
+// Uses an explicit stack, so long paths in large input graphs can't overflow the call stack.
 void Graph::dfs(int v, vector<bool>& visited, const vector<vector<int>>& localAdjList) const {
-    visited[v] = true; // Mark the current vertex as visited
-
-    // Loop over all neighbors of vertex v
-    for (int neighbor : localAdjList[v]) {
-        // If the neighbor hasn't been visited yet, visit it recursively
-        if (!visited[neighbor]) {
-            dfs(neighbor, visited, localAdjList);
+    vector<int> stack = {v};
+    visited[v] = true; // Mark the start vertex as visited
+    while (!stack.empty()) {
+        int u = stack.back();
+        stack.pop_back();
+        // Push every neighbor that hasn't been visited yet
+        for (int neighbor : localAdjList[u]) {
+            if (!visited[neighbor]) {
+                visited[neighbor] = true;
+                stack.push_back(neighbor);
+            }
         }
     }
 }
@@ -106,37 +136,54 @@ bool Graph::hasEulerCircuit() const {
     return true;
 }
 
-// Finds and returns an Euler circuit starting from the given vertex
-vector<int> Graph::findEulerCircuit(int start) {
+// Collects a streamed circuit into a vector
+class VectorSink : public EulerSink {
+public:
     vector<int> circuit;
+    void emit(int v) override { circuit.push_back(v); }
+    void finish(bool reversed) override {
+        if (reversed) reverse(circuit.begin(), circuit.end()); // Restore walk order
+    }
+};
 
-    // If the graph does not have an Euler circuit, return an empty vector
-    if (!hasEulerCircuit()) return circuit;
+// Finds and returns an Euler circuit starting from the given vertex
+vector<int> Graph::findEulerCircuit(int start) const {
+    VectorSink sink;
+    streamEulerCircuit(sink, start);
+    return sink.circuit;// Return the final Euler circuit
+}
 
-    vector<vector<int>> tempAdj = adjList;// Make a temporary copy of the adjacency list to modify
-    stack<int> path;// Stack to track the current path in the traversal
-    vector<int> result;// To store the final Euler circuit in reverse
+// Hierholzer's algorithm over edge ids with a used-edge bitmap and a per-vertex cursor into adjList.
+// Each vertex goes to the sink the moment it is finalized, nothing but the stack is held in memory.
+// Finalize order is the circuit walked backwards: for an undirected graph that is itself a valid
+// circuit, for a directed graph the sink is told to reverse it.
+bool Graph::streamEulerCircuit(EulerSink& sink, int start) const {
+    // If the graph does not have an Euler circuit, emit nothing
+    if (!hasEulerCircuit()) return false;
+    // A start without edges has no circuit through it: emit nothing, like part9's findEulerCircuit
+    if (start < 0 || start >= numVertices || adjList[start].empty()) return false;
 
-    path.push(start);// Begin traversal at the starting vertex
+    vector<bool> used(edgeEnds.size(), false); // used[id] is set once the edge is walked
+    vector<int> cursor(numVertices, 0); // cursor[v]: first slot of adjList[v] that may still be unused
+    vector<int> path;// Stack to track the current path in the traversal
+
+    path.push_back(start);// Begin traversal at the starting vertex
 
     while (!path.empty()) {
-        int v = path.top();// Look at the current vertex on top of the stack
-        if (!tempAdj[v].empty()) {
-            // While there are unused edges from v, go deeper
-            int u = tempAdj[v].back();// Choose the last neighbor
-            tempAdj[v].pop_back(); // Remove edge vu from v’s list
-            if (!directed) {
-                // For undirected graph, also remove the edge u → v from u's list
-                auto& vec = tempAdj[u];
-                vec.erase(remove(vec.begin(), vec.end(), v), vec.end());
-            }
-            path.push(u);// Continue to the neighbor u
+        int v = path.back();// Look at the current vertex on top of the stack
+        const vector<int>& ids = edgeIdList[v];
+        int& i = cursor[v];
+        while (i < (int)ids.size() && used[ids[i]]) ++i; // Skip edges walked from the other side
+        if (i < (int)ids.size()) {
+            // There is an unused edge from v, go deeper
+            used[ids[i]] = true;
+            path.push_back(adjList[v][i++]);
         } else {
             // No more edges left from v → backtrack
-            result.push_back(v);// Add v to the result
-            path.pop();// Go back to previous vertex
+            sink.emit(v);// Hand v to the sink
+            path.pop_back();// Go back to previous vertex
         }
     }
-    reverse(result.begin(), result.end());// Reverse the result to get correct path order
-    return result;// Return the final Euler circuit
+    sink.finish(directed);
+    return true;
 }
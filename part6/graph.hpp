@@ -2,13 +2,25 @@
 #define GRAPH_H
 
 #include <vector>
+#include <utility>
 using namespace std;
 
+// Receives the vertices of an Euler circuit one at a time, in the order Hierholzer's algorithm finalizes them
+class EulerSink {
+public:
+    virtual ~EulerSink() = default;
+    virtual void emit(int v) = 0; // Next finalized vertex
+    virtual void finish(bool reversed) = 0; // End of the circuit, reversed is true when the stream runs against the edge directions
+};
+
 class Graph {
 private:
     int numVertices; // Number of vertices in the graph
     bool directed;  // Whether the graph is directed
     vector<vector<int>> adjList; // Adjacency list: adjList[u] contains neighbors of u
+    vector<vector<int>> edgeIdList; // edgeIdList[u][i] is the id of the edge (u, adjList[u][i]), shared by both directions of an undirected edge
+    vector<pair<int, int>> edgeEnds; // Endpoints of every edge id, ids are kept dense in [0, edgeEnds.size())
+    void releaseEdgeId(int id); // Give the last id the slot of a removed edge
     void dfs(int v, vector<bool>& visited, const vector<vector<int>>& localAdjList) const;  // DFS used for connectivity check (used in hasEulerCircuit)
 
 public:
@@ -21,7 +33,9 @@ public:
     int getNumVertices() const;  // Return total vertices
 
     bool hasEulerCircuit() const;// Check if Euler circuit exists
-    vector<int> findEulerCircuit(int start = 0); // Return Euler circuit starting from given vertex
+    vector<int> findEulerCircuit(int start = 0) const; // Return Euler circuit starting from given vertex
+    // Emit the circuit vertex by vertex, false (nothing emitted) if there is none or start has no edges
+    bool streamEulerCircuit(EulerSink& sink, int start = 0) const;
 };
 
 #endif
@@ -0,0 +1,130 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest.h"
+#include "graph.hpp"
+#include "euler_io.hpp"
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+
+// Collects a streamed circuit, like findEulerCircuit does
+class CollectSink : public EulerSink {
+public:
+    vector<int> vertices;
+    bool finished = false;
+    void emit(int v) override { vertices.push_back(v); }
+    void finish(bool) override { finished = true; }
+};
+
+// Read everything until the other side closes
+static string read_all(int fd) {
+    string out;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) out.append(buf, n);
+    return out;
+}
+
+// Every edge of g walked exactly once by a closed walk
+static bool is_circuit(const Graph& g, const vector<int>& c) {
+    if (c.size() < 2 || c.front() != c.back()) return false;
+    multiset<pair<int, int>> left;
+    for (int u = 0; u < g.getNumVertices(); ++u)
+        for (int v : g.getNeighbors(u))
+            if (u < v) left.insert({u, v});
+    for (size_t i = 0; i + 1 < c.size(); ++i) {
+        auto it = left.find({min(c[i], c[i + 1]), max(c[i], c[i + 1])});
+        if (it == left.end()) return false;
+        left.erase(it);
+    }
+    return left.empty();
+}
+
+TEST_CASE("streamEulerCircuit: a start without edges emits nothing") {
+    Graph g(4, false);
+    g.addEdge(1, 2); g.addEdge(2, 3); g.addEdge(3, 1);
+    CollectSink sink;
+    CHECK_FALSE(g.streamEulerCircuit(sink, 0));
+    CHECK(sink.vertices.empty());
+    CHECK_FALSE(sink.finished);
+    CHECK(g.findEulerCircuit(0).empty());
+    CHECK(is_circuit(g, g.findEulerCircuit(1)));
+
+    Graph none(3, false); // No edges at all
+    CHECK(none.findEulerCircuit(0).empty());
+}
+
+TEST_CASE("GraphParser: numbers cut by chunk boundaries parse like one buffer") {
+    const string text = "5\n0 1\n1 2\n12 3\n3 4\n4 0";
+    GraphParser whole;
+    whole.feed(text.data(), text.data() + text.size(), true);
+    REQUIRE(whole.numVertices == 5);
+    CHECK(whole.edges == vector<pair<int, int>>({{0, 1}, {1, 2}, {12, 3}, {3, 4}, {4, 0}}));
+
+    for (size_t step = 1; step <= 4; ++step) {
+        GraphParser split;
+        for (size_t i = 0; i < text.size(); i += step)
+            split.feed(text.data() + i, text.data() + min(text.size(), i + step), false);
+        split.feed(text.data(), text.data(), true);
+        CHECK(split.numVertices == 5);
+        CHECK(split.edges == whole.edges);
+    }
+
+    GraphParser stops; // Parsing stops at the first token that isn't a number
+    const string bad = "3 0 1 x 1 2";
+    stops.feed(bad.data(), bad.data() + bad.size(), true);
+    CHECK(stops.edges == vector<pair<int, int>>({{0, 1}}));
+}
+
+// Client text in, circuit text out, both through a socketpair, with a circuit several chunks long
+TEST_CASE("GraphParser and SocketSink: a ring survives the round trip over a socketpair") {
+    const int n = 30000; // About 170 KB of circuit text, three chunks
+    ostringstream request;
+    request << n << "\n";
+    for (int v = 0; v < n; ++v) request << v << " " << (v + 1) % n << "\n";
+    const string text = request.str();
+
+    int sp[2];
+    REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+    int srv = sp[0], cli = sp[1];
+    string response;
+    bool sent = true;
+    std::thread client([&] {
+        for (size_t i = 0; i < text.size(); i += 1000) // Small writes, numbers get cut
+            sent = sent && send_all(cli, text.data() + i, min<size_t>(1000, text.size() - i));
+        shutdown(cli, SHUT_WR);
+        response = read_all(cli);
+    });
+
+    GraphParser parser;
+    char buf[4096];
+    ssize_t r;
+    while ((r = read(srv, buf, sizeof(buf))) > 0) parser.feed(buf, buf + r, false);
+    parser.feed(buf, buf, true);
+    REQUIRE(parser.numVertices == n);
+    REQUIRE(parser.edges.size() == (size_t)n);
+    Graph g(parser.numVertices, false);
+    for (const auto& [u, v] : parser.edges) g.addEdge(u, v);
+    {
+        SocketSink sink(srv);
+        sink.append("Euler Circuit: ");
+        CHECK(g.streamEulerCircuit(sink));
+    }
+    shutdown(srv, SHUT_WR);
+    client.join();
+    close(srv);
+    close(cli);
+    CHECK(sent);
+
+    const string prefix = "Euler Circuit: ";
+    REQUIRE(response.compare(0, prefix.size(), prefix) == 0);
+    istringstream numbers(response.substr(prefix.size()));
+    vector<int> circuit;
+    int v;
+    while (numbers >> v) circuit.push_back(v);
+    CHECK(circuit.size() == (size_t)n + 1);
+    CHECK(is_circuit(g, circuit));
+}
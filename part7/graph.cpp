@@ -4,6 +4,9 @@
 #include <stack>
 #include <queue>
 #include <limits.h>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
 
 //constructor for the Graph class
 Graph::Graph(int vertices, bool directed) 
@@ -258,53 +261,83 @@ std::vector<std::vector<int>> Graph::findSCCs() {
 
 // ---------- Max Flow (Edmonds-Karp) ----------
 
-//BFS to find an augmenting path
-bool bfsFlow(const std::vector<std::vector<int>>& rGraph, int s, int t, std::vector<int>& parent) {
-    int n = rGraph.size();
-    std::vector<bool> visited(n, false);
-    std::queue<int> q;
-
-    q.push(s);
-    visited[s] = true;
-    parent[s] = -1;
-
-    while (!q.empty()) {
-        int u = q.front(); q.pop();
-        for (int v = 0; v < n; ++v) {
-            if (!visited[v] && rGraph[u][v] > 0) {
-                q.push(v);
-                parent[v] = u;
-                visited[v] = true;
-            }
+//residual network in CSR form: arcs of u are [offset[u], offset[u+1]), rev[a] is the paired reverse arc
+struct FlowNetwork {
+    int n = 0;
+    std::vector<int> offset, head, rev;
+    std::vector<int> baseCap; //capacities before any flow is pushed
+};
+
+//build the residual network once: each edge u->v gets capacity 1 and a reverse arc of capacity 0
+static FlowNetwork buildFlowNetwork(const std::vector<std::vector<int>>& adj) {
+    FlowNetwork net;
+    net.n = adj.size();
+    std::vector<int> degree(net.n, 0);
+    for (int u = 0; u < net.n; ++u) {
+        for (int v : adj[u]) {
+            degree[u]++;
+            degree[v]++;
         }
     }
-
-    return visited[t]; //return true if sink is reachable
+    net.offset.assign(net.n + 1, 0);
+    for (int u = 0; u < net.n; ++u) net.offset[u + 1] = net.offset[u] + degree[u];
+    int arcs = net.offset[net.n];
+    net.head.resize(arcs);
+    net.rev.resize(arcs);
+    net.baseCap.assign(arcs, 0);
+
+    std::vector<int> next(net.offset.begin(), net.offset.end() - 1); //next free slot per vertex
+    for (int u = 0; u < net.n; ++u) {
+        for (int v : adj[u]) {
+            int a = next[u]++, b = next[v]++;
+            net.head[a] = v; net.rev[a] = b; net.baseCap[a] = 1;
+            net.head[b] = u; net.rev[b] = a;
+        }
+    }
+    return net;
 }
 
-int Graph::maxFlow(int source, int sink) {
-    //initialize residual graph
-    std::vector<std::vector<int>> rGraph(numVertices, std::vector<int>(numVertices, 0));
-    for (int u = 0; u < numVertices; ++u)
-        for (int v : adjList[u])
-            rGraph[u][v] += 1; //edge capacity is 1
+//BFS to find an augmenting path, parentArc[v] is the arc used to reach v
+bool bfsFlow(const FlowNetwork& net, const std::vector<int>& cap, int s, int t,
+             std::vector<int>& parentArc, std::vector<int>& queue) {
+    std::fill(parentArc.begin(), parentArc.end(), -1);
+    queue.clear();
+    queue.push_back(s);
+    parentArc[s] = -2; //marks the source as visited
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int u = queue[head];
+        for (int a = net.offset[u]; a < net.offset[u + 1]; ++a) {
+            int v = net.head[a];
+            if (parentArc[v] == -1 && cap[a] > 0) {
+                parentArc[v] = a;
+                if (v == t) return true; //sink is reachable
+                queue.push_back(v);
+            }
+        }
+    }
+    return false;
+}
 
-    std::vector<int> parent(numVertices);
+//edmonds-karp on a residual network whose capacities were already reset in 'cap'
+static int edmondsKarp(const FlowNetwork& net, std::vector<int>& cap, int s, int t,
+                       std::vector<int>& parentArc, std::vector<int>& queue) {
+    if (s == t) return 0;
     int max_flow = 0;
 
     //while there's an augmenting path
-    while (bfsFlow(rGraph, source, sink, parent)) {
+    while (bfsFlow(net, cap, s, t, parentArc, queue)) {
         int path_flow = INT_MAX;
 
         //find minimum capacity in the path
-        for (int v = sink; v != source; v = parent[v])
-            path_flow = std::min(path_flow, rGraph[parent[v]][v]);
+        for (int v = t; v != s; v = net.head[net.rev[parentArc[v]]])
+            path_flow = std::min(path_flow, cap[parentArc[v]]);
 
         //update residual capacities
-        for (int v = sink; v != source; v = parent[v]) {
-            int u = parent[v];
-            rGraph[u][v] -= path_flow;
-            rGraph[v][u] += path_flow;
+        for (int v = t; v != s; v = net.head[net.rev[parentArc[v]]]) {
+            int a = parentArc[v];
+            cap[a] -= path_flow;
+            cap[net.rev[a]] += path_flow;
         }
 
         max_flow += path_flow;
@@ -312,3 +345,40 @@ int Graph::maxFlow(int source, int sink) {
 
     return max_flow;
 }
+
+int Graph::maxFlow(int source, int sink) {
+    return maxFlows({{source, sink}}, 1).front();
+}
+
+//max flow for every (source, sink) pair on one residual network, pairs are split between threads
+std::vector<int> Graph::maxFlows(const std::vector<std::pair<int, int>>& pairs, int threads) const {
+    for (const auto& [s, t] : pairs) {
+        if (s < 0 || s >= numVertices || t < 0 || t >= numVertices) {
+            throw std::invalid_argument("Error: Invalid vertex index.\n");
+        }
+    }
+    std::vector<int> flows(pairs.size(), 0);
+    if (pairs.empty()) return flows;
+
+    const FlowNetwork net = buildFlowNetwork(adjList);
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<int>(threads, pairs.size());
+
+    std::atomic<size_t> nextPair{0};
+    auto worker = [&]() {
+        //per-thread scratch, capacities are reset in place before every query
+        std::vector<int> cap(net.baseCap.size());
+        std::vector<int> parentArc(net.n), queue;
+        queue.reserve(net.n);
+        for (size_t i = nextPair++; i < pairs.size(); i = nextPair++) {
+            std::copy(net.baseCap.begin(), net.baseCap.end(), cap.begin());
+            flows[i] = edmondsKarp(net, cap, pairs[i].first, pairs[i].second, parentArc, queue);
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 1; i < threads; ++i) pool.emplace_back(worker);
+    worker(); //the calling thread takes a share too
+    for (auto& th : pool) th.join();
+    return flows;
+}
@@ -2,6 +2,7 @@
 #define GRAPH_H
 
 #include <vector>
+#include <utility>
 using namespace std;
 
 class Graph {
@@ -28,6 +29,8 @@ public:
     int countCliques();
     std::vector<std::vector<int>> findSCCs();
     int maxFlow(int source, int sink);
+    //max flow for each (source, sink) pair, the residual network is built once and shared by 'threads' workers (0 = hardware)
+    std::vector<int> maxFlows(const std::vector<std::pair<int, int>>& pairs, int threads = 0) const;
 };
 
 #endif
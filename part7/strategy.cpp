@@ -19,7 +19,12 @@ void SCCStrategy::execute(Graph& graph) const {
     }
 }
 
+MaxFlowStrategy::MaxFlowStrategy(std::vector<std::pair<int, int>> pairs) : pairs(std::move(pairs)) {}
+
 void MaxFlowStrategy::execute(Graph& graph) const {
-    int maxFlowValue = graph.maxFlow(0, graph.getNumVertices() - 1); //calculate max flow
-    std::cout << "Max Flow from 0 to " << graph.getNumVertices()-1 << ": " << maxFlowValue << std::endl; //print result
+    auto queries = pairs;
+    if (queries.empty()) queries.push_back({0, graph.getNumVertices() - 1}); //default pair
+    auto flows = graph.maxFlows(queries); //one residual network for all pairs
+    for (size_t i = 0; i < queries.size(); ++i)
+        std::cout << "Max Flow from " << queries[i].first << " to " << queries[i].second << ": " << flows[i] << std::endl; //print result
 }
@@ -3,6 +3,8 @@
 
 #include "graph.hpp"
 #include <memory>
+#include <utility>
+#include <vector>
 
 //base interface for all graph algorithms
 class IGraphAlgorithm {
@@ -32,7 +34,12 @@ public:
 //strategy for maximum flow
 class MaxFlowStrategy : public IGraphAlgorithm {
 public:
+    //(source, sink) pairs to solve, empty means 0 to n-1
+    explicit MaxFlowStrategy(std::vector<std::pair<int, int>> pairs = {});
     void execute(Graph& graph) const override;
+
+private:
+    std::vector<std::pair<int, int>> pairs;
 };
 
 #endif
@@ -2,6 +2,7 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <vector>
+#include <string>
 #include <cerrno>  
 
 // Reads from 'sock' until it sees 'delim' (e.g., '\n').
@@ -42,18 +43,23 @@ bool recv_until_delim(int sock, char delim, std::string& out, std::string& stash
 
 //Function for sending request to server
 bool send_request(int sock){
-    std::cout << "Choose Action:\n1. Send graph\n2. Random graph\nFor ending send '0'\n";
+    std::cout << "Choose Action:\n1. Send graph\n2. Random graph\n"
+                 "3. Send graph with max flow pairs\n4. Random graph with max flow pairs\n"
+                 "5. Graph file on the server with max flow pairs\n"
+                 "6-8. Like 3-5, running only the chosen algorithms\nFor ending send '0'\n";
     int choice; std::cin >> choice;
     //if(choice == 0) return false;
-    while (choice < 0 || choice > 2) {
+    while (choice < 0 || choice > 8) {
             std::cout << "Unknown option, choose new one:\n"; 
             std::cin >> choice; 
         }
 
     //Sending request
     write(sock, &choice, sizeof(choice));
+    bool masked = choice >= 6; //Same request as choice - 3, then the algorithm mask
+    if (masked) choice -= 3;
 
-    if (choice == 1) { //Send graph
+    if (choice == 1 || choice == 3) { //Send graph
         std::cout << "Enter number of vertices: ";
         int V; std::cin >> V;
         write(sock, &V, sizeof(V));
@@ -66,7 +72,7 @@ bool send_request(int sock){
             write(sock, &v, sizeof(v));
             if (u == -1 && v == -1) break;
         }
-    } else if(choice == 2){ //random graph
+    } else if(choice == 2 || choice == 4){ //random graph
         std::cout << "Enter number of vertices: ";
         int V; 
         std::cin >> V; write(sock, &V, sizeof(V));
@@ -78,9 +84,33 @@ bool send_request(int sock){
         std::cout << "Enter seed: ";
         int s; 
         std::cin >> s; write(sock, &s, sizeof(s));
+    } else if (choice == 5) { //graph file name, relative to the server's data directory
+        std::cout << "Enter graph file name (in the server data directory): ";
+        std::string path;
+        std::cin >> path;
+        int len = path.size();
+        write(sock, &len, sizeof(len));
+        write(sock, path.data(), len);
     }else{ // choice == 0, no more requests
         return false;
     }
+    if (choice >= 3) { //max flow pairs
+        std::cout << "Enter number of (source sink) pairs: ";
+        int k; 
+        std::cin >> k; write(sock, &k, sizeof(k));
+        std::cout << "Enter pairs (s t):\n";
+        for (int i = 0; i < k; ++i) {
+            int s, t;
+            std::cin >> s >> t;
+            write(sock, &s, sizeof(s));
+            write(sock, &t, sizeof(t));
+        }
+    }
+    if (masked) { //Algorithms to run
+        std::cout << "Enter algorithms mask (1 MST, 2 cliques, 4 SCCs, 8 max flow, add to combine): ";
+        int mask;
+        std::cin >> mask; write(sock, &mask, sizeof(mask));
+    }
     return true;
 }
 
@@ -0,0 +1,205 @@
+#include "compressed_graph.hpp"
+#include "graph_algorithms.hpp"
+#include "workspace.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+// Workspace used when the caller doesn't pass one, one per thread
+static thread_local Workspace threadWorkspace;
+
+static Workspace& pick(Workspace* ws) {
+    return ws ? *ws : threadWorkspace;
+}
+
+static void writeVarint(std::vector<uint8_t>& out, uint32_t x) {
+    while (x >= 0x80) {
+        out.push_back(uint8_t(x) | 0x80);
+        x >>= 7;
+    }
+    out.push_back(uint8_t(x));
+}
+
+CompressedGraph::Builder::Builder(int vertices, bool directed) : g(vertices, directed) {
+    if (vertices < 0) throw std::invalid_argument("Error: Invalid number of vertices.\n");
+    g.offset.reserve(vertices + 1);
+    if (!directed) {
+        mate.resize(vertices);
+        mateAt.resize(vertices);
+    }
+}
+
+void CompressedGraph::Builder::addArc(int u, int v) {
+    if (u < 0 || u >= g.numVertices || v < 0 || v >= g.numVertices || u == v) {
+        throw std::invalid_argument("Error: Invalid vertex index.\n");
+    }
+    if (u < current || (u == current && !row.empty() && v <= row.back())) {
+        throw std::invalid_argument("Error: Arcs must be sorted by source, then target, without repeats.\n");
+    }
+    if (u > current) advance(u);
+    if (!g.directed && v < u) { // Row v is encoded already: u must be the next neighbor waiting there
+        if (mate[v] != u) throw std::invalid_argument("Error: Undirected graph needs both directions of every edge.\n");
+        const uint8_t* p = g.bytes.data() + mateAt[v];
+        const uint8_t* end = g.bytes.data() + (size_t(v) + 1 < g.offset.size() ? g.offset[v + 1] : g.bytes.size());
+        mate[v] = p == end ? -1 : mate[v] + static_cast<int>(readVarint(p)) + 1;
+        mateAt[v] = p - g.bytes.data();
+    }
+    row.push_back(v);
+    ++arcs;
+}
+
+// Each row: degree, zigzag(first neighbor - vertex), then gaps minus one
+void CompressedGraph::Builder::advance(int to) {
+    for (; current < to; ++current) {
+        g.offset.push_back(g.bytes.size());
+        writeVarint(g.bytes, row.size());
+        size_t above = std::upper_bound(row.begin(), row.end(), current) - row.begin(); // First neighbor > current
+        for (size_t k = 0; k < row.size(); ++k) {
+            if (k == 0) {
+                int64_t d = int64_t(row[0]) - current;
+                writeVarint(g.bytes, d < 0 ? uint32_t(-d - 1) * 2 + 1 : uint32_t(d) * 2);
+            } else {
+                writeVarint(g.bytes, row[k] - row[k - 1] - 1);
+            }
+            if (k == above && !g.directed) mateAt[current] = g.bytes.size();
+        }
+        if (!g.directed) mate[current] = above < row.size() ? row[above] : -1;
+        row.clear();
+    }
+}
+
+CompressedGraph CompressedGraph::Builder::finish() {
+    advance(g.numVertices);
+    for (int m : mate) { // Every arc back was matched when it came, so only arcs forward can be left over
+        if (m >= 0) throw std::invalid_argument("Error: Undirected graph needs both directions of every edge.\n");
+    }
+    std::vector<int>().swap(mate);
+    std::vector<uint64_t>().swap(mateAt);
+    g.offset.push_back(g.bytes.size());
+    g.bytes.shrink_to_fit();
+    g.numEdges = g.directed ? arcs : arcs / 2;
+    return std::move(g);
+}
+
+// Sort one row, drop repeats and hand it to the builder
+static void addRow(CompressedGraph::Builder& out, int u, std::vector<int>& row) {
+    std::sort(row.begin(), row.end());
+    row.erase(std::unique(row.begin(), row.end()), row.end());
+    for (int v : row) out.addArc(u, v);
+}
+
+CompressedGraph::CompressedGraph(const Graph& g) : CompressedGraph(g.getNumVertices(), g.isDirected()) {
+    Builder out(numVertices, directed);
+    std::vector<int> row;
+    for (int u = 0; u < numVertices; ++u) {
+        row = g.getNeighbors(u); // Undirected edges appear in both lists already
+        addRow(out, u, row);
+    }
+    *this = out.finish();
+}
+
+CompressedGraph::CompressedGraph(int vertices, bool directed, const std::vector<std::pair<int, int>>& edges)
+    : CompressedGraph(vertices, directed) {
+    if (vertices < 0) throw std::invalid_argument("Error: Invalid number of vertices.\n");
+    // Bucket the ends per source as CSR (counting sort), both directions when undirected
+    std::vector<size_t> start(vertices + 1, 0);
+    for (const auto& [u, v] : edges) {
+        if (u < 0 || u >= vertices || v < 0 || v >= vertices || u == v) {
+            throw std::invalid_argument("Error: Invalid vertex index.\n");
+        }
+        start[u + 1]++;
+        if (!directed) start[v + 1]++;
+    }
+    for (int v = 0; v < vertices; ++v) start[v + 1] += start[v];
+    std::vector<int> target(start[vertices]);
+    {
+        std::vector<size_t> fill(start.begin(), start.end() - 1);
+        for (const auto& [u, v] : edges) {
+            target[fill[u]++] = v;
+            if (!directed) target[fill[v]++] = u;
+        }
+    }
+    Builder out(vertices, directed);
+    std::vector<int> row;
+    for (int u = 0; u < vertices; ++u) {
+        row.assign(target.begin() + start[u], target.begin() + start[u + 1]);
+        addRow(out, u, row);
+    }
+    *this = out.finish();
+}
+
+int CompressedGraph::degree(int v) const {
+    if (v < 0 || v >= numVertices) throw std::invalid_argument("Error: Invalid vertex index.\n");
+    const uint8_t* p = bytes.data() + offset[v];
+    return readVarint(p);
+}
+
+CompressedGraph::NeighborRange CompressedGraph::neighbors(int v) const {
+    if (v < 0 || v >= numVertices) throw std::invalid_argument("Error: Invalid vertex index.\n");
+    const uint8_t* p = bytes.data() + offset[v];
+    int deg = readVarint(p);
+    return {NeighborIterator(p, deg, v), NeighborIterator()};
+}
+
+size_t CompressedGraph::memoryBytes() const {
+    return offset.capacity() * sizeof(uint64_t) + bytes.capacity();
+}
+
+// Unit weights: a spanning forest has one edge per union that joins two trees
+int64_t CompressedGraph::mstWeight(Workspace* wsp) const {
+    if (directed) return -1; // MST is for undirected graphs only
+    std::vector<int>& dsu = pick(wsp).components;
+    dsu.assign(numVertices, -1);
+    int64_t weight = 0;
+    int edgeComponents = 0;
+    for (int u = 0; u < numVertices; ++u)
+        for (int v : row(u)) weight += dsuUnion(dsu, u, v, edgeComponents);
+    return weight;
+}
+
+// Balanced degrees and every edge in one (weakly) connected component, as in Graph::hasEulerCircuit
+bool CompressedGraph::hasEulerCircuit(Workspace* wsp) const {
+    if (numEdges == 0) return false; // No edges in the graph
+    Workspace& ws = pick(wsp);
+    std::vector<int>& balance = ws.minEdge; // Directed: out - in, undirected: degree
+    balance.assign(numVertices, 0);
+    std::vector<int>& dsu = ws.components;
+    dsu.assign(numVertices, -1);
+    int edgeComponents = 0;
+    for (int u = 0; u < numVertices; ++u) {
+        for (int v : row(u)) {
+            ++balance[u];
+            if (directed) --balance[v];
+            dsuUnion(dsu, u, v, edgeComponents);
+        }
+    }
+    for (int v = 0; v < numVertices; ++v)
+        if (directed ? balance[v] != 0 : balance[v] % 2 != 0) return false;
+    return edgeComponents == 1;
+}
+
+// The DFS frames keep their position in the compressed list, so nothing is decoded twice
+std::vector<std::vector<int>> CompressedGraph::findSCCs(Workspace* wsp) const {
+    StopPoll never(nullptr);
+    std::vector<std::pair<int, NeighborIterator>> frames;
+    return sccKosaraju(numVertices, [this](int v) { return row(v); }, frames, pick(wsp), never);
+}
+
+std::vector<int> CompressedGraph::bfsDistances(int source, Workspace* wsp) const {
+    if (source < 0 || source >= numVertices) throw std::invalid_argument("Error: Invalid vertex index.\n");
+    Workspace& ws = pick(wsp);
+    std::vector<int> dist(numVertices, -1);
+    std::vector<int>& queue = ws.queue;
+    queue.clear();
+    queue.push_back(source);
+    dist[source] = 0;
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int u = queue[head];
+        for (int v : row(u)) {
+            if (dist[v] == -1) {
+                dist[v] = dist[u] + 1;
+                queue.push_back(v);
+            }
+        }
+    }
+    return dist;
+}
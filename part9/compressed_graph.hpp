@@ -0,0 +1,130 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include <utility>
+#include "graph.hpp"
+
+class Workspace;
+
+// Read-only adjacency for graphs too large for Graph's vector-per-vertex lists.
+// Each vertex's neighbors are sorted and stored as byte-aligned varints (LEB128): the degree,
+// the first neighbor minus the vertex itself (zigzag signed), then every gap minus one. Per vertex that is one 8-byte offset, and per
+// neighbor about one byte when the ids are close together (e.g. after Graph::vertexOrder).
+// Traversals decode on the fly through NeighborIterator.
+class CompressedGraph {
+public:
+    // Forward iterator over the neighbors of one vertex, in increasing order
+    class NeighborIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = int;
+
+        NeighborIterator() = default;
+        int operator*() const { return value; }
+        NeighborIterator& operator++() {
+            if (--left > 0) value += static_cast<int>(readVarint(p)) + 1;
+            return *this;
+        }
+        NeighborIterator operator++(int) {
+            NeighborIterator old = *this;
+            ++*this;
+            return old;
+        }
+        bool operator==(const NeighborIterator& o) const { return left == o.left; } // Same list only
+        bool operator!=(const NeighborIterator& o) const { return left != o.left; }
+
+    private:
+        friend class CompressedGraph;
+        NeighborIterator(const uint8_t* p, int left, int base) : p(p), left(left) {
+            if (left > 0) {
+                uint32_t z = readVarint(this->p);
+                value = base + (z & 1 ? -static_cast<int>(z >> 1) - 1 : static_cast<int>(z >> 1));
+            }
+        }
+        const uint8_t* p = nullptr; // Next encoded gap
+        int left = 0; // Neighbors not yet passed, including the current one
+        int value = 0;
+    };
+
+    struct NeighborRange {
+        NeighborIterator first, last;
+        NeighborIterator begin() const { return first; }
+        NeighborIterator end() const { return last; }
+    };
+
+    class Builder;
+
+    explicit CompressedGraph(const Graph& g); // Snapshot of g, encoded one sorted row at a time
+    // Built straight from an edge list, so huge inputs never need a Graph: the ends are bucketed per vertex
+    // (one int per arc) and each row is sorted on its own. Duplicates are dropped, self loops and out of
+    // range ends throw like Graph::addEdge.
+    CompressedGraph(int vertices, bool directed, const std::vector<std::pair<int, int>>& edges);
+
+    int getNumVertices() const { return numVertices; }
+    bool isDirected() const { return directed; }
+    int64_t getNumEdges() const { return numEdges; } // An undirected edge counts once
+    int degree(int v) const; // Out-degree
+    NeighborRange neighbors(int v) const;
+    size_t memoryBytes() const; // Bytes held by the adjacency (offsets plus encoded lists)
+
+    // Same results as the Graph versions, decoded straight from the compressed lists. The union-find and
+    // Kosaraju code is the one Graph runs (graph_algorithms.hpp); findSCCs builds the reversed graph as a
+    // plain CSR in the workspace while it runs.
+    int64_t mstWeight(Workspace* ws = nullptr) const; // Spanning forest weight, -1 when directed
+    bool hasEulerCircuit(Workspace* ws = nullptr) const;
+    std::vector<std::vector<int>> findSCCs(Workspace* ws = nullptr) const;
+    std::vector<int> bfsDistances(int source, Workspace* ws = nullptr) const; // Hops from source, -1 if unreachable
+
+private:
+    int numVertices;
+    bool directed;
+    int64_t numEdges = 0;
+    std::vector<uint64_t> offset; // Lists of v are bytes [offset[v], offset[v+1])
+    std::vector<uint8_t> bytes;
+
+    CompressedGraph(int vertices, bool directed) : numVertices(vertices), directed(directed) {}
+    NeighborRange row(int v) const { // neighbors(v) without the range check
+        const uint8_t* p = bytes.data() + offset[v];
+        int deg = readVarint(p);
+        return {NeighborIterator(p, deg, v), NeighborIterator()};
+    }
+    static uint32_t readVarint(const uint8_t*& p) {
+        uint32_t x = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t b = *p++;
+            x |= uint32_t(b & 0x7f) << shift;
+            if (!(b & 0x80)) return x;
+        }
+    }
+};
+
+// Encodes a graph arc by arc, so it never exists uncompressed: arcs come sorted by source, then target
+// (the order of a graph file), and an undirected graph gives both directions of every edge. Only the
+// row being gathered is buffered, plus for an undirected graph a cursor per vertex (12 bytes) into its
+// encoded row, which pairs every arc v -> u (u < v) with the arc u -> v. Out of order or repeated arcs,
+// self loops and out of range ends throw invalid_argument, as does an undirected graph whose arcs don't pair up.
+class CompressedGraph::Builder {
+public:
+    Builder(int vertices, bool directed);
+    void addArc(int u, int v);
+    CompressedGraph finish(); // Vertices after the last source get no neighbors
+
+private:
+    CompressedGraph g;
+    int current = 0; // Source whose row is being gathered
+    std::vector<int> row;
+    int64_t arcs = 0;
+    // Undirected: mate[u] is the next neighbor v > u whose arc v -> u hasn't come yet (-1 when none is left),
+    // mateAt[u] the byte position of the gap after it in the encoded row. Sources come in increasing order,
+    // so the arcs back to u must arrive in the order of its row.
+    std::vector<int> mate;
+    std::vector<uint64_t> mateAt;
+
+    void advance(int to); // Encode the rows of current .. to - 1
+};
+
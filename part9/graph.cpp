@@ -1,45 +1,88 @@
 #include "graph.hpp"           
+#include "workspace.hpp"
+#include "stop_token.hpp"
+#include "graph_algorithms.hpp"
 #include <iostream>       
 #include <algorithm>   
-#include <stack>
-#include <queue>
 #include <limits.h>
+#include <thread>
+#include <atomic>
+#include <stdexcept>
+#include <exception>
+#include <iterator>
+#include <cstdlib>
+#include <memory>
+
+// Workspace used when the caller doesn't pass one, one per thread
+static thread_local Workspace threadWorkspace;
+
+static Workspace& pick(Workspace* ws) {
+    return ws ? *ws : threadWorkspace;
+}
 
 // Constructor for the Graph class
-Graph::Graph(int vertices, bool directed) : numVertices(vertices),  directed(directed), adjList(vertices) {}       
+Graph::Graph(int vertices, bool directed) : numVertices(vertices),  directed(directed), adjList(vertices), edgeIdList(vertices),
+    outDeg(vertices, 0), inDeg(vertices, 0), dsu(vertices, -1) {}       
 
 // Function to add an edge between two vertices u and v
 void Graph::addEdge(int u, int v) {
     if (u < 0 || u >= numVertices || v < 0 || v >= numVertices || u == v) {  // Check if u and v are valid indices
         throw std::invalid_argument("Error: Invalid vertex index.\n");  // Throw error if they are out of range                                           
     }
-    if(find(adjList[u].begin(), adjList[u].end(), v) == adjList[u].end()){
-        adjList[u].push_back(v); // Add v to u's adjacency list
+    if(find(adjList[u].begin(), adjList[u].end(), v) != adjList[u].end()){
+        return; // Edge already exists
     }
+    int id = edgeEnds.size(); // Next free edge id
+    edgeEnds.push_back({u, v});
+    updateDegree(u, 1, 0);
+    updateDegree(v, directed ? 0 : 1, directed ? 1 : 0);
+    if (componentsStale) rebuildComponents(); // Also covers the new edge
+    else dsuUnion(dsu, u, v, edgeComponents);
+    adjList.mut(u).push_back(v); // Add v to u's adjacency list
+    edgeIdList.mut(u).push_back(id);
     if (!directed) { // If the graph is undirected
-        if(find(adjList[v].begin(), adjList[v].end(), u) == adjList[v].end()){
-            adjList[v].push_back(u);// Add u to v's adjacency list as well
-        }
+        adjList.mut(v).push_back(u);// Add u to v's adjacency list as well
+        edgeIdList.mut(v).push_back(id);// Both directions share one id
     }
 }
 
+// Position of v in a neighbor list, -1 if absent
+static int findNeighbor(const vector<int>& neighbors, int v) {
+    auto it = std::find(neighbors.begin(), neighbors.end(), v);
+    return it == neighbors.end() ? -1 : it - neighbors.begin();
+}
+
+// Erase entry i of a neighbor list and the matching id
+static void eraseNeighbor(vector<int>& neighbors, vector<int>& ids, int i) {
+    neighbors.erase(neighbors.begin() + i);
+    ids.erase(ids.begin() + i);
+}
+
 // Function to remove an edge between two vertices u and v
 void Graph::removeEdge(int u, int v) {
     if (u < 0 || u >= numVertices || v < 0 || v >= numVertices || u == v) {  // Check if u and v are valid indices
         throw std::invalid_argument("Error: Invalid vertex index.\n");  // Throw error if they are out of range ;                                                
     }
-    auto& neighborsU = adjList[u]; // Reference to u's adjacency list
-    neighborsU.erase(                                              
-        std::remove(neighborsU.begin(), neighborsU.end(), v), // Find v in u's list and move it to the end
-        neighborsU.end() // Erase the found element(s)
-    );
+    // Looked up through the shared rows, so removing a missing edge doesn't clone them
+    int i = findNeighbor(adjList[u], v);
+    if (i == -1) return; // No such edge
+    int id = edgeIdList[u][i];
+    eraseNeighbor(adjList.mut(u), edgeIdList.mut(u), i);
     if (!directed) {  // If the graph is undirected
-        auto& neighborsV = adjList[v]; // Reference to v's adjacency list
-        neighborsV.erase(                                          
-            std::remove(neighborsV.begin(), neighborsV.end(), u),  // Find u in v's list and move it to the end
-            neighborsV.end() // Erase the found element(s)
-        );
+        eraseNeighbor(adjList.mut(v), edgeIdList.mut(v), findNeighbor(adjList[v], u)); // Find u in v's list and erase it
+    }
+    updateDegree(u, -1, 0);
+    updateDegree(v, directed ? 0 : -1, directed ? -1 : 0);
+    componentsStale = true; // The edge may have been a bridge
+    // Keep ids dense: the last id takes over the freed one
+    int last = edgeEnds.size() - 1;
+    if (id != last) {
+        auto [a, b] = edgeEnds[last];
+        edgeEnds.set(id, edgeEnds[last]);
+        for (int& e : edgeIdList.mut(a)) if (e == last) e = id;
+        if (!directed) for (int& e : edgeIdList.mut(b)) if (e == last) e = id;
     }
+    edgeEnds.pop_back();
 }
 
 // Function to print the adjacency list of the graph
@@ -61,120 +104,195 @@ const std::vector<int>& Graph::getNeighbors(int v) const {
     return adjList[v];         
 }
 
+// Function to get the number of edges in the graph
+int Graph::getNumEdges() const {
+    return edgeEnds.size();
+}
+
 // Function to get the total number of vertices in the graph
 int Graph::getNumVertices() const {
     return numVertices;                        
 }
 
-// Depth-First Search helper function to mark all reachable vertices
-void Graph::dfs(int v, vector<bool>& visited, const vector<vector<int>>& localAdjList) const {
-    visited[v] = true; // Mark the current vertex as visited
+bool Graph::isDirected() const {
+    return directed;
+}
 
-    // Loop over all neighbors of vertex v
-    for (int neighbor : localAdjList[v]) {
-        // If the neighbor hasn't been visited yet, visit it recursively
-        if (!visited[neighbor]) {
-            dfs(neighbor, visited, localAdjList);
-        }
-    }
+// Change the degree of x and keep the odd-degree / imbalance counters in sync
+void Graph::updateDegree(int x, int dOut, int dIn) {
+    auto weight = [&]{ return directed ? std::abs(outDeg[x] - inDeg[x]) : (outDeg[x] & 1); };
+    int before = weight();
+    outDeg[x] += dOut;
+    inDeg[x] += dIn;
+    int after = weight();
+    unbalanced += (after != 0) - (before != 0);
+    imbalance += after - before;
 }
 
-// Checks whether the graph contains an Euler circuit
-bool Graph::hasEulerCircuit() const {
-    vector<bool> visited(numVertices, false); // Visited array for DFS
-    int start = -1; // First vertex with edges
+// Rebuild the union-find from the edge list (after removals)
+void Graph::rebuildComponents() {
+    dsu.assign(numVertices, -1);
+    edgeComponents = 0;
+    for (const auto& [u, v] : edgeEnds) dsuUnion(dsu, u, v, edgeComponents);
+    componentsStale = false;
+}
 
-    vector<int> indeg(numVertices, 0), outdeg(numVertices, 0); // Degree counters
+// Number of components with edges, a local union-find is built only while the member one is stale
+int Graph::countEdgeComponents(Workspace* ws) const {
+    if (!componentsStale) return edgeComponents;
+    vector<int>& local = pick(ws).components;
+    local.assign(numVertices, -1);
+    int count = 0;
+    for (const auto& [u, v] : edgeEnds) dsuUnion(local, u, v, count);
+    return count;
+}
 
-    // Find a vertex with edges and calculate in/out degrees
-    for (int u = 0; u < numVertices; ++u) {
-        for (int v : adjList[u]) {
-            outdeg[u]++;
-            indeg[v]++;
-            if (start == -1) start = u;
-        }
-    }
-    // No edges in the graph
-    if (start == -1) return false;
-    if (directed) {
-        // Check if in-degree equals out-degree for all vertices
-        for (int i = 0; i < numVertices; ++i) {
-            if (indeg[i] != outdeg[i]) return false;
-        }
-        // DFS in original graph
-        dfs(start, visited, adjList);
-        for (int i = 0; i < numVertices; ++i) {
-            if ((indeg[i] + outdeg[i] > 0) && !visited[i]) return false;
-        }
-        // DFS in reversed graph
-        vector<vector<int>> rev(numVertices);
-        for (int u = 0; u < numVertices; ++u)
-            for (int v : adjList[u]) rev[v].push_back(u);
-        fill(visited.begin(), visited.end(), false);
-        dfs(start, visited, rev);
-        for (int i = 0; i < numVertices; ++i) {
-            if ((indeg[i] + outdeg[i] > 0) && !visited[i]) return false;
-        }
+// Checks whether the graph contains an Euler circuit.
+// Degrees are balanced and all edges are in one (weakly) connected component; for a directed
+// graph balanced degrees make that component strongly connected, so no reverse-graph DFS is needed.
+bool Graph::hasEulerCircuit(Workspace* ws) const {
+    if (edgeEnds.empty()) return false; // No edges in the graph
+    return unbalanced == 0 && countEdgeComponents(ws) == 1;
+}
 
-        return true;
-    } 
-    else {
-        // DFS in undirected graph
-        dfs(start, visited, adjList);
-        for (int i = 0; i < numVertices; ++i) {
-            if (!adjList[i].empty() && !visited[i]) return false;
-        }
-        // Check all vertices have even degree
-        for (int i = 0; i < numVertices; ++i) {
-            if (adjList[i].size() % 2 != 0) return false;
-        }
+// Checks whether the graph contains an Euler path: a circuit, or an open trail between the two odd
+// vertices (directed: from the vertex with out - in = 1 to the one with in - out = 1)
+bool Graph::hasEulerPath(Workspace* ws) const {
+    if (edgeEnds.empty()) return false;
+    bool degreesOk = (unbalanced == 0) || (unbalanced == 2 && imbalance == 2);
+    return degreesOk && countEdgeComponents(ws) == 1;
+}
 
-        return true;
+// Finds and returns an Euler path, an open trail starts at its odd (out-heavy) end
+vector<int> Graph::findEulerPath() const {
+    if (!hasEulerPath()) return {};
+    int start = -1;
+    for (int v = 0; v < numVertices && start == -1; ++v) {
+        bool isStart = directed ? (outDeg[v] - inDeg[v] == 1) : (outDeg[v] % 2 == 1);
+        if (isStart) start = v;
     }
+    // Balanced degrees: any vertex with edges starts a circuit
+    for (int v = 0; v < numVertices && start == -1; ++v) {
+        if (!adjList[v].empty()) start = v;
+    }
+    return hierholzer(start);
 }
 
-
 // Finds and returns an Euler circuit starting from the given vertex
-vector<int> Graph::findEulerCircuit(int start) {
-    vector<int> circuit;
-
+vector<int> Graph::findEulerCircuit(int start) const {
     // If the graph does not have an Euler circuit, return an empty vector
-    if (!hasEulerCircuit()) return circuit;
-
-    vector<vector<int>> tempAdj = adjList;// Make a temporary copy of the adjacency list to modify
-    stack<int> path;// Stack to track the current path in the traversal
-    vector<int> result;// To store the final Euler circuit in reverse
+    if (!hasEulerCircuit()) return {};
+    if (start < 0 || start >= numVertices || adjList[start].empty()) return {}; // Circuit can't pass through start
+    return hierholzer(start);
+}
 
-    path.push(start);// Begin traversal at the starting vertex
+// Hierholzer's algorithm over edge ids: a used-edge bitmap and a per-vertex cursor into adjList
+// replace the old copy-and-erase of the adjacency, so every edge slot is looked at once (O(V+E)).
+vector<int> Graph::hierholzer(int start) const {
+    vector<int> circuit;
+    vector<bool> used(edgeEnds.size(), false); // used[id] is set once the edge is walked
+    vector<int> cursor(numVertices, 0); // cursor[v]: first slot of adjList[v] that may still be unused
+    vector<int> path; // Stack of the current trail
+    circuit.reserve(edgeEnds.size() + 1);
+    path.push_back(start);// Begin traversal at the starting vertex
 
     while (!path.empty()) {
-        int v = path.top();// Look at the current vertex on top of the stack
-        if (!tempAdj[v].empty()) {
-            // While there are unused edges from v, go deeper
-            int u = tempAdj[v].back();// Choose the last neighbor
-            tempAdj[v].pop_back(); // Remove edge vu from v’s list
-            if (!directed) {
-                // For undirected graph, also remove the edge u → v from u's list
-                auto& vec = tempAdj[u];
-                vec.erase(remove(vec.begin(), vec.end(), v), vec.end());
-            }
-            path.push(u);// Continue to the neighbor u
+        int v = path.back();// Look at the current vertex on top of the stack
+        const vector<int>& ids = edgeIdList[v];
+        int& i = cursor[v];
+        while (i < (int)ids.size() && used[ids[i]]) ++i; // Skip edges walked from the other side
+        if (i < (int)ids.size()) {
+            // There is an unused edge from v, go deeper
+            used[ids[i]] = true;
+            path.push_back(adjList[v][i++]);
         } else {
             // No more edges left from v → backtrack
-            result.push_back(v);// Add v to the result
-            path.pop();// Go back to previous vertex
+            circuit.push_back(v);// Add v to the result
+            path.pop_back();// Go back to previous vertex
         }
     }
-    reverse(result.begin(), result.end());// Reverse the result to get correct path order
-    return result;// Return the final Euler circuit
+    reverse(circuit.begin(), circuit.end());// Vertices are finalized in reverse order
+    return circuit;// Return the final Euler trail
 }
 
 //Remove all edges of the graph
 void Graph::removeAllEdges(){
-    for (auto &inner : adjList) {
-        inner.clear();
+    adjList.assign(numVertices);
+    edgeIdList.assign(numVertices);
+    edgeEnds.clear();
+    fill(outDeg.begin(), outDeg.end(), 0);
+    fill(inDeg.begin(), inDeg.end(), 0);
+    unbalanced = imbalance = 0;
+    dsu.assign(numVertices, -1);
+    edgeComponents = 0;
+    componentsStale = false;
+}
+
+Graph Graph::fromCSR(int vertices, bool directed, const uint64_t* offset, const uint32_t* target) {
+    Graph g(vertices, directed);
+    uint64_t backward = 0; // Undirected: arcs u -> v with v < u, each must pair with an edge added from v
+    for (int u = 0; u < vertices; ++u) {
+        for (uint64_t a = offset[u]; a < offset[u + 1]; ++a) {
+            int v = target[a];
+            if (v < 0 || v >= vertices || v == u) throw invalid_argument("Error: Invalid vertex index.\n");
+            if (a > offset[u] && target[a - 1] >= target[a]) {
+                throw invalid_argument("Error: Adjacency rows must be sorted and unique.\n");
+            }
+            if (!directed && v < u) { // Added from the other end, whose row is already checked sorted
+                if (!std::binary_search(target + offset[v], target + offset[v + 1], uint32_t(u))) {
+                    throw invalid_argument("Error: Undirected graph needs both directions of every edge.\n");
+                }
+                ++backward;
+                continue;
+            }
+            int id = g.edgeEnds.size();
+            g.edgeEnds.push_back({u, v});
+            g.updateDegree(u, 1, 0);
+            g.updateDegree(v, directed ? 0 : 1, directed ? 1 : 0);
+            g.adjList.mut(u).push_back(v);
+            g.edgeIdList.mut(u).push_back(id);
+            if (!directed) {
+                g.adjList.mut(v).push_back(u);
+                g.edgeIdList.mut(v).push_back(id);
+            }
+        }
+    }
+    // Every backward arc has its own forward mate (rows are unique), so equal counts leave no forward arc unpaired
+    if (!directed && backward != g.edgeEnds.size()) {
+        throw invalid_argument("Error: Undirected graph needs both directions of every edge.\n");
+    }
+    g.rebuildComponents();
+    return g;
+}
+
+Graph Graph::fromEdges(int vertices, bool directed, const vector<pair<int, int>>& edges) {
+    if (vertices < 0) throw invalid_argument("Error: Invalid number of vertices.\n");
+    vector<uint64_t> offset(vertices + 1, 0);
+    for (const auto& [u, v] : edges) {
+        if (u < 0 || u >= vertices || v < 0 || v >= vertices || u == v) {
+            throw invalid_argument("Error: Invalid vertex index.\n");
+        }
+        offset[u + 1]++;
+        if (!directed) offset[v + 1]++;
+    }
+    for (int v = 0; v < vertices; ++v) offset[v + 1] += offset[v];
+    vector<uint32_t> target(offset[vertices]);
+    vector<uint64_t> fill(offset.begin(), offset.end() - 1);
+    for (const auto& [u, v] : edges) {
+        target[fill[u]++] = v;
+        if (!directed) target[fill[v]++] = u;
+    }
+    // Sort every row and drop repeated neighbors, compacting in place
+    uint64_t out = 0;
+    for (int u = 0; u < vertices; ++u) {
+        uint64_t begin = offset[u], end = offset[u + 1];
+        std::sort(target.begin() + begin, target.begin() + end);
+        offset[u] = out;
+        for (uint64_t a = begin; a < end; ++a)
+            if (a == begin || target[a] != target[out - 1]) target[out++] = target[a];
     }
-    adjList.clear();
+    offset[vertices] = out;
+    return fromCSR(vertices, directed, offset.data(), target.data());
 }
 
 //Build graph with random edges according to a given number ef edges and vertices
@@ -213,27 +331,119 @@ Graph Graph::buildRandGraph(int numOfEdges, int numOfVartx, int seed){
     return graph;
 }
 
+// Add x to total, throwing instead of silently wrapping when Acc is too narrow
+template <typename Acc>
+static void accumulate(Acc& total, Acc x) {
+    if (__builtin_add_overflow(total, x, &total)) {
+        throw std::overflow_error("Error: Result does not fit the accumulator type.\n");
+    }
+}
+
+// ---------- Vertex reordering ----------
+// Layouts that put vertices visited together next to each other, so traversals touch fewer cache lines
+
+vector<int> Graph::vertexOrder(VertexOrder kind, Workspace* wsp) const {
+    vector<int> order(numVertices);
+    for (int v = 0; v < numVertices; ++v) order[v] = v;
+    if (kind == VertexOrder::Original) return order;
+    auto degree = [this](int v) { return outDeg[v] + inDeg[v]; };
+    if (kind == VertexOrder::DegreeDescending) {
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return degree(a) > degree(b); });
+        return order;
+    }
+
+    // BFS layers over out-neighbors, one tree per unvisited root. RCM takes the roots by increasing
+    // degree, enqueues neighbors by increasing degree and reverses the whole order at the end.
+    bool rcm = kind == VertexOrder::ReverseCuthillMcKee;
+    vector<int> roots = order;
+    if (rcm) std::stable_sort(roots.begin(), roots.end(), [&](int a, int b) { return degree(a) < degree(b); });
+    Workspace& ws = pick(wsp);
+    ws.begin(numVertices);
+    order.clear();
+    vector<int> next; // Unvisited neighbors of the vertex being expanded
+    for (int root : roots) {
+        if (ws.visited(root)) continue;
+        ws.visit(root);
+        size_t head = order.size();
+        order.push_back(root);
+        while (head < order.size()) {
+            int u = order[head++];
+            next.clear();
+            for (int v : adjList[u]) {
+                if (!ws.visited(v)) {
+                    ws.visit(v);
+                    next.push_back(v);
+                }
+            }
+            if (rcm) std::stable_sort(next.begin(), next.end(), [&](int a, int b) { return degree(a) < degree(b); });
+            order.insert(order.end(), next.begin(), next.end());
+        }
+    }
+    if (rcm) std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Vertex i of the copy is vertex order[i] of this graph, edge ids are kept and neighbor lists are sorted
+Graph Graph::relabeled(const vector<int>& order) const {
+    if ((int)order.size() != numVertices) throw invalid_argument("Error: Invalid vertex order.\n");
+    vector<int> position(numVertices, -1);
+    for (int i = 0; i < numVertices; ++i) {
+        int v = order[i];
+        if (v < 0 || v >= numVertices || position[v] != -1) throw invalid_argument("Error: Invalid vertex order.\n");
+        position[v] = i;
+    }
+
+    Graph g(numVertices, directed);
+    for (const auto& [u, v] : edgeEnds) g.edgeEnds.push_back({position[u], position[v]});
+    vector<pair<int, int>> row; // (neighbor, edge id) of one vertex in the new labels
+    for (int i = 0; i < numVertices; ++i) {
+        int v = order[i];
+        g.outDeg[i] = outDeg[v];
+        g.inDeg[i] = inDeg[v];
+        row.clear();
+        for (size_t k = 0; k < adjList[v].size(); ++k) row.push_back({position[adjList[v][k]], edgeIdList[v][k]});
+        std::sort(row.begin(), row.end());
+        vector<int>& adj = g.adjList.mut(i);
+        vector<int>& ids = g.edgeIdList.mut(i);
+        adj.reserve(row.size());
+        ids.reserve(row.size());
+        for (const auto& [w, id] : row) {
+            adj.push_back(w);
+            ids.push_back(id);
+        }
+    }
+    g.unbalanced = unbalanced;
+    g.imbalance = imbalance;
+    g.rebuildComponents();
+    return g;
+}
+
 // ---------- Minimum Spanning Tree (Prim's) ----------
-int Graph::mstWeight() const {
+// Vertices unreachable from the current tree start a new one, so a disconnected graph gets its spanning forest weight
+template <typename Acc>
+Acc Graph::mstWeight(Workspace* wsp, const StopToken* stop) const {
     if (directed) return -1; // MST is for undirected graphs only
-    int totalWeight = 0;
-    std::vector<bool> visited(numVertices, false);
-    std::vector<int> minEdge(numVertices, INT_MAX);
-    minEdge[0] = 0;
+    Workspace& ws = pick(wsp);
+    Acc totalWeight = 0;
+    ws.begin(numVertices); // Visited = already in the tree
+    std::vector<int>& minEdge = ws.minEdge;
+    minEdge.assign(numVertices, INT_MAX);
 
+    StopPoll stopped(stop, 16); // Every step scans all vertices
     for (int i = 0; i < numVertices; ++i) {
+        if (stopped()) break;
         int u = -1;
         for (int v = 0; v < numVertices; ++v) {
-            if (!visited[v] && (u == -1 || minEdge[v] < minEdge[u])) {
+            if (!ws.visited(v) && (u == -1 || minEdge[v] < minEdge[u])) {
                 u = v;
             }
         }
 
-        visited[u] = true;
-        totalWeight += minEdge[u];
+        ws.visit(u);
+        if (minEdge[u] != INT_MAX) accumulate(totalWeight, Acc(minEdge[u]));
 
         for (int neighbor : adjList[u]) {
-            if (!visited[neighbor]) {
+            if (!ws.visited(neighbor)) {
                 minEdge[neighbor] = std::min(minEdge[neighbor], 1); // Weight is 1
             }
         }
@@ -241,115 +451,499 @@ int Graph::mstWeight() const {
     return totalWeight;
 }
 
-// ---------- Counting Cliques (brute force) ----------
-bool isClique(const std::vector<int>& subset, const std::vector<std::vector<int>>& adj) {
-    for (size_t i = 0; i < subset.size(); ++i) {
-        for (size_t j = i + 1; j < subset.size(); ++j) {
-            int u = subset[i], v = subset[j];
-            if (std::find(adj[u].begin(), adj[u].end(), v) == adj[u].end())
-                return false;
-        }
+template int Graph::mstWeight<int>(Workspace*, const StopToken*) const;
+template int64_t Graph::mstWeight<int64_t>(Workspace*, const StopToken*) const;
+
+// ---------- Counting Cliques ----------
+// Count every clique that extends the current one by a vertex of 'cand'.
+// 'cand' is sorted by rank and holds only vertices ranked above the last one added, higher[v] holds the
+// neighbors of v ranked above v, so each clique is reached exactly once, in increasing rank order.
+template <typename Acc, typename Less>
+static void extendCliques(const std::vector<std::vector<int>>& higher, const std::vector<int>& cand, Acc& count, Less less,
+                          StopPoll& stopped) {
+    for (size_t i = 0; i < cand.size(); ++i) {
+        if (stopped()) return;
+        int v = cand[i];
+        accumulate(count, Acc(1)); // Current clique plus v
+        std::vector<int> next;
+        std::set_intersection(cand.begin() + i + 1, cand.end(), higher[v].begin(), higher[v].end(),
+                              std::back_inserter(next), less);
+        if (!next.empty()) extendCliques(higher, next, count, less, stopped);
     }
-    return true;
 }
 
-int Graph::countCliques() {
-    int count = 0;
-    int n = numVertices;
-    for (int mask = 1; mask < (1 << n); ++mask) {
-        std::vector<int> subset;
-        for (int i = 0; i < n; ++i)
-            if (mask & (1 << i))
-                subset.push_back(i);
-        if (isClique(subset, adjList)) count++;
+// A set is a clique when for every u < v in it (by rank, default: by id), v is a neighbor of u
+template <typename Acc>
+Acc Graph::countCliques(const vector<int>* rank, const StopToken* stop) const {
+    std::vector<int> ids;
+    if (!rank) { // Rank = id
+        ids.resize(numVertices);
+        for (int v = 0; v < numVertices; ++v) ids[v] = v;
+        rank = &ids;
     }
+    const vector<int>& r = *rank;
+    auto less = [&r](int a, int b) { return r[a] < r[b]; };
+    std::vector<std::vector<int>> higher(numVertices);
+    for (int u = 0; u < numVertices; ++u) {
+        for (int v : adjList[u])
+            if (r[v] > r[u]) higher[u].push_back(v);
+        std::sort(higher[u].begin(), higher[u].end(), less);
+    }
+    std::vector<int> all(numVertices);
+    for (int v = 0; v < numVertices; ++v) all[v] = v;
+    std::sort(all.begin(), all.end(), less);
+
+    Acc count = 0;
+    StopPoll stopped(stop);
+    extendCliques(higher, all, count, less, stopped);
     return count;
 }
 
-// ---------- Strongly Connected Components (Kosaraju) ----------
-void dfs1(int v, std::vector<bool>& visited, std::stack<int>& order, const std::vector<std::vector<int>>& adj) {
-    visited[v] = true;
-    for (int u : adj[v])
-        if (!visited[u]) dfs1(u, visited, order, adj);
-    order.push(v);
+template uint16_t Graph::countCliques<uint16_t>(const vector<int>*, const StopToken*) const;
+template uint32_t Graph::countCliques<uint32_t>(const vector<int>*, const StopToken*) const;
+template uint64_t Graph::countCliques<uint64_t>(const vector<int>*, const StopToken*) const;
+
+// ---------- Strongly Connected Components (Kosaraju, see graph_algorithms.hpp) ----------
+std::vector<std::vector<int>> Graph::findSCCs(Workspace* wsp, const StopToken* stop) const {
+    StopPoll stopped(stop);
+    Workspace& ws = pick(wsp);
+    auto rows = [this](int v) {
+        const std::vector<int>& row = adjList[v];
+        return IntRange{row.data(), row.data() + row.size()};
+    };
+    return sccKosaraju(numVertices, rows, ws.frames, ws, stopped);
 }
 
-void dfs2(int v, std::vector<bool>& visited, std::vector<int>& component, const std::vector<std::vector<int>>& revAdj) {
-    visited[v] = true;
-    component.push_back(v);
-    for (int u : revAdj[v])
-        if (!visited[u]) dfs2(u, visited, component, revAdj);
+// ---------- Max Flow (Edmonds-Karp) ----------
+// Build the residual CSR (FlowNetwork, see workspace.hpp) in place: every adjacency entry u->v becomes
+// an arc of capacity 1 plus a reverse arc of capacity 0 stored at v.
+static void buildFlowNetwork(const SharedRows<int>& adj, FlowNetwork& net) {
+    net.n = adj.size();
+    net.offset.assign(net.n + 1, 0);
+    for (int u = 0; u < net.n; ++u) {
+        for (int v : adj[u]) {
+            net.offset[u + 1]++;
+            net.offset[v + 1]++;
+        }
+    }
+    for (int u = 0; u < net.n; ++u) net.offset[u + 1] += net.offset[u];
+    int arcs = net.offset[net.n];
+    net.head.resize(arcs);
+    net.rev.resize(arcs);
+    net.baseCap.assign(arcs, 0);
+
+    net.fill.assign(net.offset.begin(), net.offset.end() - 1); // Next free slot per vertex
+    for (int u = 0; u < net.n; ++u) {
+        for (int v : adj[u]) {
+            int a = net.fill[u]++, b = net.fill[v]++;
+            net.head[a] = v; net.rev[a] = b; net.baseCap[a] = 1;
+            net.head[b] = u; net.rev[b] = a;
+        }
+    }
 }
 
-std::vector<std::vector<int>> Graph::findSCCs() {
-    std::stack<int> order;
-    std::vector<bool> visited(numVertices, false);
-
-    for (int i = 0; i < numVertices; ++i)
-        if (!visited[i]) dfs1(i, visited, order, adjList);
-
-    std::vector<std::vector<int>> revAdj(numVertices);
-    for (int u = 0; u < numVertices; ++u)
-        for (int v : adjList[u])
-            revAdj[v].push_back(u);
+// BFS over arcs with remaining capacity, ws.parentArc[v] is the arc used to reach v
+bool bfsFlow(const FlowNetwork& net, const std::vector<int>& cap, int s, int t, Workspace& ws) {
+    ws.begin(net.n);
+    ws.parentArc.resize(net.n);
+    ws.queue.clear();
+    ws.queue.push_back(s);
+    ws.visit(s);
+
+    for (size_t head = 0; head < ws.queue.size(); ++head) {
+        int u = ws.queue[head];
+        for (int a = net.offset[u]; a < net.offset[u + 1]; ++a) {
+            int v = net.head[a];
+            if (!ws.visited(v) && cap[a] > 0) {
+                ws.visit(v);
+                ws.parentArc[v] = a;
+                if (v == t) return true;
+                ws.queue.push_back(v);
+            }
+        }
+    }
+    return false;
+}
 
-    std::fill(visited.begin(), visited.end(), false);
-    std::vector<std::vector<int>> components;
+// Edmonds-Karp on a residual network whose capacities are already reset in 'cap'.
+// Arc capacities stay 32 bit, only the total is summed in Acc. When stopped, the flow pushed so far (a lower bound).
+template <typename Acc>
+static Acc edmondsKarp(const FlowNetwork& net, std::vector<int>& cap, int s, int t, Workspace& ws,
+                       const StopToken* stop = nullptr) {
+    if (s == t) return 0;
+    Acc max_flow = 0;
+    const std::vector<int>& parentArc = ws.parentArc;
+    StopPoll stopped(stop, 1); // Every augmenting path is a BFS over the whole network
+    while (!stopped() && bfsFlow(net, cap, s, t, ws)) {
+        int path_flow = INT_MAX;
+        for (int v = t; v != s; v = net.head[net.rev[parentArc[v]]])
+            path_flow = std::min(path_flow, cap[parentArc[v]]);
 
-    while (!order.empty()) {
-        int v = order.top(); order.pop();
-        if (!visited[v]) {
-            std::vector<int> component;
-            dfs2(v, visited, component, revAdj);
-            components.push_back(component);
+        for (int v = t; v != s; v = net.head[net.rev[parentArc[v]]]) {
+            int a = parentArc[v];
+            cap[a] -= path_flow;
+            cap[net.rev[a]] += path_flow;
         }
+        accumulate(max_flow, Acc(path_flow));
     }
-    return components;
+    return max_flow;
 }
 
-// ---------- Max Flow (Edmonds-Karp) ----------
-bool bfsFlow(const std::vector<std::vector<int>>& rGraph, int s, int t, std::vector<int>& parent) {
-    int n = rGraph.size();
-    std::vector<bool> visited(n, false);
-    std::queue<int> q;
-
-    q.push(s);
-    visited[s] = true;
-    parent[s] = -1;
-
-    while (!q.empty()) {
-        int u = q.front(); q.pop();
-        for (int v = 0; v < n; ++v) {
-            if (!visited[v] && rGraph[u][v] > 0) {
-                q.push(v);
-                parent[v] = u;
-                visited[v] = true;
+// Mark every vertex reachable from s over arcs with remaining capacity (the source side of the min cut) as visited in ws
+static void residualReach(const FlowNetwork& net, const std::vector<int>& cap, int s, Workspace& ws) {
+    ws.begin(net.n);
+    ws.queue.clear();
+    ws.queue.push_back(s);
+    ws.visit(s);
+    for (size_t head = 0; head < ws.queue.size(); ++head) {
+        int u = ws.queue[head];
+        for (int a = net.offset[u]; a < net.offset[u + 1]; ++a) {
+            int v = net.head[a];
+            if (!ws.visited(v) && cap[a] > 0) {
+                ws.visit(v);
+                ws.queue.push_back(v);
             }
         }
     }
-    return visited[t];
 }
 
-int Graph::maxFlow(int source, int sink) {
-    std::vector<std::vector<int>> rGraph(numVertices, std::vector<int>(numVertices, 0));
-    for (int u = 0; u < numVertices; ++u)
+int64_t Graph::maxFlow(int source, int sink, MinCut* cut, Workspace* wsp) {
+    if (!cut) return maxFlows<int64_t>({{source, sink}}, 1, wsp).front();
+    if (source < 0 || source >= numVertices || sink < 0 || sink >= numVertices) {
+        throw std::invalid_argument("Error: Invalid vertex index.\n");
+    }
+    Workspace& ws = pick(wsp);
+    buildFlowNetwork(adjList, ws.flow);
+    ws.cap.assign(ws.flow.baseCap.begin(), ws.flow.baseCap.end());
+    int64_t flow = edmondsKarp<int64_t>(ws.flow, ws.cap, source, sink, ws);
+
+    residualReach(ws.flow, ws.cap, source, ws);
+    cut->value = flow;
+    cut->sourceSide.clear();
+    cut->cutEdges.clear();
+    for (int u = 0; u < numVertices; ++u) {
+        if (!ws.visited(u)) continue;
+        cut->sourceSide.push_back(u);
         for (int v : adjList[u])
-            rGraph[u][v] += 1;
+            if (!ws.visited(v)) cut->cutEdges.push_back({u, v});
+    }
+    return flow;
+}
 
-    std::vector<int> parent(numVertices);
-    int max_flow = 0;
+// Max flow for every (source, sink) pair on one residual network, pairs are split between threads.
+// The network lives in the caller's workspace; each extra thread uses one of its helpers for capacities and BFS.
+template <typename Acc>
+std::vector<Acc> Graph::maxFlows(const std::vector<std::pair<int, int>>& pairs, int threads, Workspace* wsp,
+                                 const StopToken* stop) const {
+    for (const auto& [s, t] : pairs) {
+        if (s < 0 || s >= numVertices || t < 0 || t >= numVertices) {
+            throw std::invalid_argument("Error: Invalid vertex index.\n");
+        }
+    }
+    std::vector<Acc> flows(pairs.size(), 0);
+    if (pairs.empty()) return flows;
+
+    Workspace& mine = pick(wsp);
+    buildFlowNetwork(adjList, mine.flow);
+    const FlowNetwork& net = mine.flow;
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min<int>(threads, pairs.size());
+
+    std::atomic<size_t> nextPair{0};
+    auto worker = [&](Workspace& ws) {
+        // Capacities are reset in place before every query. Once stopped, pairs not started keep a flow of 0.
+        for (size_t i = nextPair++; i < pairs.size(); i = nextPair++) {
+            if (stop && stop->stopRequested()) break;
+            ws.cap.assign(net.baseCap.begin(), net.baseCap.end());
+            flows[i] = edmondsKarp<Acc>(net, ws.cap, pairs[i].first, pairs[i].second, ws, stop);
+        }
+    };
+
+    while ((int)mine.helpers.size() < threads - 1) mine.helpers.push_back(std::make_unique<Workspace>());
+    // Sized up front: a thread that gets no pair in this call must not allocate in the next one
+    mine.reserveFlow(net);
+    for (int i = 0; i < threads - 1; ++i) mine.helpers[i]->reserveFlow(net);
+    // A failure (e.g. overflow_error from a narrow Acc) ends the pairs for every thread and is rethrown here,
+    // after the join: escaping a std::thread it would terminate the process
+    std::vector<std::exception_ptr> errors(threads);
+    auto run = [&](int i, Workspace& ws) {
+        try {
+            worker(ws);
+        } catch (...) {
+            errors[i] = std::current_exception();
+            nextPair = pairs.size();
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (int i = 1; i < threads; ++i) pool.emplace_back([&, i]{ run(i, *mine.helpers[i - 1]); });
+    run(0, mine); // The calling thread takes a share too
+    for (auto& th : pool) th.join();
+    for (auto& e : errors)
+        if (e) std::rethrow_exception(e);
+    return flows;
+}
 
-    while (bfsFlow(rGraph, source, sink, parent)) {
-        int path_flow = INT_MAX;
-        for (int v = sink; v != source; v = parent[v])
-            path_flow = std::min(path_flow, rGraph[parent[v]][v]);
+template std::vector<int> Graph::maxFlows<int>(const std::vector<std::pair<int, int>>&, int, Workspace*, const StopToken*) const;
+template std::vector<int64_t> Graph::maxFlows<int64_t>(const std::vector<std::pair<int, int>>&, int, Workspace*,
+                                                       const StopToken*) const;
 
-        for (int v = sink; v != source; v = parent[v]) {
-            int u = parent[v];
-            rGraph[u][v] -= path_flow;
-            rGraph[v][u] += path_flow;
+// ---------- Gomory-Hu Tree (Gusfield) ----------
+int64_t GomoryHuTree::minCut(int u, int v) const {
+    int n = parent.size();
+    if (u < 0 || u >= n || v < 0 || v >= n) {
+        throw std::invalid_argument("Error: Invalid vertex index.\n");
+    }
+    if (u == v) return 0;
+    // Depth of each endpoint, then climb the deeper one until both meet
+    auto depth = [&](int x) { int d = 0; for (; parent[x] != -1; x = parent[x]) ++d; return d; };
+    int du = depth(u), dv = depth(v);
+    int64_t best = INT64_MAX;
+    while (du > dv) { best = std::min(best, weight[u]); u = parent[u]; --du; }
+    while (dv > du) { best = std::min(best, weight[v]); v = parent[v]; --dv; }
+    while (u != v) {
+        best = std::min({best, weight[u], weight[v]});
+        u = parent[u];
+        v = parent[v];
+    }
+    return best;
+}
+
+// Gusfield: for s = 1..n-1 cut s from parent[s]; later vertices on the source side that share
+// that parent are re-hung under s. The cuts of a window of consecutive vertices are computed
+// in parallel with the current parents; a result is discarded and recomputed if an earlier
+// vertex of the window re-hung it.
+GomoryHuTree Graph::gomoryHuTree(int threads) const {
+    if (directed) {
+        throw std::invalid_argument("Error: Gomory-Hu tree requires an undirected graph.\n");
+    }
+    GomoryHuTree tree;
+    tree.parent.assign(numVertices, 0);
+    tree.weight.assign(numVertices, 0);
+    if (numVertices == 0) return tree;
+    tree.parent[0] = -1;
+
+    FlowNetwork net;
+    buildFlowNetwork(adjList, net);
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Per-worker state, kept across windows
+    struct Slot {
+        Workspace ws;
+        std::vector<char> sourceSide;
+        int sink = -1;
+        int64_t flow = 0;
+    };
+    std::vector<Slot> slots(threads);
+
+    int s = 1;
+    while (s < numVertices) {
+        int window = std::min(threads, numVertices - s);
+        auto solve = [&](int k) {
+            Slot& slot = slots[k];
+            slot.sink = tree.parent[s + k];
+            slot.ws.cap.assign(net.baseCap.begin(), net.baseCap.end());
+            slot.flow = edmondsKarp<int64_t>(net, slot.ws.cap, s + k, slot.sink, slot.ws);
+            residualReach(net, slot.ws.cap, s + k, slot.ws);
+            slot.sourceSide.resize(numVertices);
+            for (int v = 0; v < numVertices; ++v) slot.sourceSide[v] = slot.ws.visited(v);
+        };
+        // An exception is rethrown after the join, escaping a std::thread it would terminate the process
+        std::vector<std::exception_ptr> errors(window);
+        auto run = [&](int k) {
+            try {
+                solve(k);
+            } catch (...) {
+                errors[k] = std::current_exception();
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int k = 1; k < window; ++k) pool.emplace_back(run, k);
+        run(0);
+        for (auto& th : pool) th.join();
+        for (auto& e : errors)
+            if (e) std::rethrow_exception(e);
+
+        // Apply in order, stop at the first cut that was computed against a stale parent
+        int k = 0;
+        for (; k < window; ++k) {
+            int v = s + k;
+            if (slots[k].sink != tree.parent[v]) break;
+            tree.weight[v] = slots[k].flow;
+            for (int i = v + 1; i < numVertices; ++i) {
+                if (slots[k].sourceSide[i] && tree.parent[i] == slots[k].sink) tree.parent[i] = v;
+            }
         }
-        max_flow += path_flow;
+        s += k;
     }
-    return max_flow;
+    return tree;
+}
+
+// ---------- Parallel Euler Circuit ----------
+// Lock-free union-find: a root links under the other root with a CAS, always toward the smaller index,
+// so concurrent unions can't build a cycle and exactly one of two racing unions of the same sets succeeds
+class AtomicDsu {
+    std::vector<std::atomic<int>> parent;
+public:
+    explicit AtomicDsu(int n) : parent(n) {
+        for (int i = 0; i < n; ++i) parent[i].store(i, std::memory_order_relaxed);
+    }
+    int find(int x) {
+        for (;;) {
+            int p = parent[x].load(std::memory_order_acquire);
+            if (p == x) return x;
+            int gp = parent[p].load(std::memory_order_acquire);
+            if (gp != p) parent[x].compare_exchange_weak(p, gp, std::memory_order_acq_rel); // Path halving
+            x = gp;
+        }
+    }
+    // True only for the call that actually joined two different sets
+    bool unite(int a, int b) {
+        for (;;) {
+            a = find(a);
+            b = find(b);
+            if (a == b) return false;
+            if (a < b) std::swap(a, b);
+            int expected = a;
+            if (parent[a].compare_exchange_strong(expected, b, std::memory_order_acq_rel)) return true;
+        }
+    }
+};
+
+// Run fn(begin, end) on contiguous slices of [0, n), one slice per thread
+template <typename Fn>
+static void parallelFor(int n, int threads, Fn fn) {
+    threads = std::max(1, std::min(threads, n));
+    std::vector<std::thread> pool;
+    for (int k = 1; k < threads; ++k) {
+        pool.emplace_back(fn, (int)((int64_t)n * k / threads), (int)((int64_t)n * (k + 1) / threads));
+    }
+    fn(0, n / threads);
+    for (auto& th : pool) th.join();
+}
+
+// At every vertex the incident edges are paired into transitions (enter by one, leave by the other).
+// Following transitions splits the edges into closed trails; a union over each pair labels the trails.
+// Then, per vertex, every transition whose trail is not yet joined to the trail of the vertex's first
+// transition is swapped with it, which splices the two closed trails into one. The joins form a spanning
+// forest over the trails, so for a connected graph one closed trail - the Euler circuit - remains and is
+// read off by following transitions. Everything except that final walk runs on the worker threads.
+vector<int> Graph::findEulerCircuitParallel(int start, int threads, bool verify) const {
+    if (!hasEulerCircuit()) return {};
+    if (start < 0 || start >= numVertices || adjList[start].empty()) return {}; // Circuit can't pass through start
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const int n = numVertices;
+    const int m = edgeEnds.size();
+
+    // Departure slots are the adjList entries; arrival slots are the same slots when undirected, in-edges when directed
+    vector<int> outBase(n + 1, 0), inBase(n + 1, 0);
+    for (int v = 0; v < n; ++v) {
+        outBase[v + 1] = outBase[v] + adjList[v].size();
+        inBase[v + 1] = inBase[v] + (directed ? inDeg[v] : 0);
+    }
+    vector<int> slotEdge(outBase[n]); // Edge id of every departure slot
+    vector<int> inEdge(directed ? m : 0); // Directed: edge id of every arrival slot
+    vector<int> arrival(directed ? m : 2 * m); // Directed: arrival slot of edge e. Undirected: slot of e at its first / second end
+    vector<int> partner(outBase[n]); // Transition: arrival slot -> departure slot at the same vertex
+    std::unique_ptr<std::atomic<int>[]> inFill(directed ? new std::atomic<int>[n] : nullptr);
+    if (directed) for (int v = 0; v < n; ++v) inFill[v].store(inBase[v], std::memory_order_relaxed);
+
+    parallelFor(n, threads, [&](int begin, int end) {
+        for (int v = begin; v < end; ++v) {
+            for (size_t i = 0; i < adjList[v].size(); ++i) {
+                int slot = outBase[v] + i, e = edgeIdList[v][i];
+                slotEdge[slot] = e;
+                if (directed) {
+                    int in = inFill[adjList[v][i]].fetch_add(1, std::memory_order_relaxed);
+                    inEdge[in] = e;
+                    arrival[e] = in;
+                } else {
+                    arrival[2 * e + (edgeEnds[e].first == v ? 0 : 1)] = slot;
+                }
+            }
+        }
+    });
+
+    // Pair the k-th arrival with the k-th departure slot (undirected: slots 2k and 2k+1) and label the trails
+    AtomicDsu trail(m);
+    parallelFor(n, threads, [&](int begin, int end) {
+        for (int v = begin; v < end; ++v) {
+            int b = outBase[v], deg = outBase[v + 1] - b;
+            if (directed) {
+                for (int k = 0; k < deg; ++k) {
+                    partner[inBase[v] + k] = b + k;
+                    trail.unite(inEdge[inBase[v] + k], slotEdge[b + k]);
+                }
+            } else {
+                for (int k = 0; k + 1 < deg; k += 2) {
+                    partner[b + k] = b + k + 1;
+                    partner[b + k + 1] = b + k;
+                    trail.unite(slotEdge[b + k], slotEdge[b + k + 1]);
+                }
+            }
+        }
+    });
+
+    // Splice trails that meet at a vertex
+    AtomicDsu joined(m);
+    parallelFor(n, threads, [&](int begin, int end) {
+        for (int v = begin; v < end; ++v) {
+            int b = outBase[v], deg = outBase[v + 1] - b;
+            if (deg == 0) continue;
+            if (directed) {
+                int a0 = inBase[v]; // First transition a0 -> partner[a0]
+                int t0 = trail.find(inEdge[a0]);
+                for (int k = 1; k < deg; ++k) {
+                    int ak = inBase[v] + k;
+                    if (joined.unite(t0, trail.find(inEdge[ak]))) std::swap(partner[a0], partner[ak]);
+                }
+            } else {
+                int x0 = b; // First transition x0 <-> partner[x0]
+                int t0 = trail.find(slotEdge[x0]);
+                for (int k = 2; k < deg; k += 2) {
+                    int xk = b + k;
+                    if (!joined.unite(t0, trail.find(slotEdge[xk]))) continue;
+                    // (x0, y0), (xk, yk) -> (x0, xk), (y0, yk)
+                    int y0 = partner[x0], yk = partner[xk];
+                    partner[x0] = xk; partner[xk] = x0;
+                    partner[y0] = yk; partner[yk] = y0;
+                }
+            }
+        }
+    });
+
+    // Follow the transitions from the first slot of start
+    vector<int> circuit;
+    circuit.reserve(m + 1);
+    circuit.push_back(start);
+    int first = outBase[start], depart = first, v = start;
+    do {
+        int e = slotEdge[depart];
+        int side = (edgeEnds[e].first == v) ? 0 : 1;
+        v = side == 0 ? edgeEnds[e].second : edgeEnds[e].first;
+        circuit.push_back(v);
+        depart = directed ? partner[arrival[e]] : partner[arrival[2 * e + (1 - side)]];
+    } while (depart != first);
+
+    if (verify && !isEulerCircuit(circuit)) {
+        throw std::logic_error("Error: Parallel Euler circuit failed verification.\n");
+    }
+    return circuit;
+}
+
+// Checks that 'circuit' is closed and that its steps are exactly the edges of the graph
+bool Graph::isEulerCircuit(const vector<int>& circuit) const {
+    if (circuit.size() != edgeEnds.size() + 1 || circuit.front() != circuit.back()) return false;
+    auto key = [&](int u, int v) { return (!directed && u > v) ? std::make_pair(v, u) : std::make_pair(u, v); };
+    vector<pair<int, int>> walked, edges;
+    walked.reserve(edgeEnds.size());
+    edges.reserve(edgeEnds.size());
+    for (size_t i = 0; i + 1 < circuit.size(); ++i) {
+        if (circuit[i] < 0 || circuit[i] >= numVertices) return false;
+        walked.push_back(key(circuit[i], circuit[i + 1]));
+    }
+    for (const auto& [u, v] : edgeEnds) edges.push_back(key(u, v));
+    std::sort(walked.begin(), walked.end());
+    std::sort(edges.begin(), edges.end());
+    return walked == edges;
 }
@@ -2,16 +2,59 @@
 #define GRAPH_H
 
 #include <vector>
+#include <utility>
+#include <cstdint>
+#include "shared_rows.hpp"
 using namespace std;
 
+class Workspace; // Reusable scratch buffers, see workspace.hpp
+class StopToken; // Cooperative cancellation, see stop_token.hpp
+
+// Minimum s-t cut read from the final residual network of a max flow
+struct MinCut {
+    int64_t value = 0; // Capacity of the cut (equals the max flow)
+    vector<int> sourceSide; // Vertices still reachable from the source
+    vector<pair<int, int>> cutEdges; // Edges u->v with u on the source side and v on the sink side
+};
+
+// Flow-equivalent (Gomory-Hu) tree: the min cut between u and v is the lightest edge on their tree path
+struct GomoryHuTree {
+    vector<int> parent; // parent[0] == -1, tree edge (v, parent[v]) for every other v
+    vector<int64_t> weight; // weight[v] is the min cut value between v and parent[v]
+    int64_t minCut(int u, int v) const; // O(V) lookup of the min cut between u and v
+};
+
+class Graph;
+// Graph handed to concurrent readers (Pipling jobs). Only an alias, not a separate type: what keeps it read-only is
+// that readers get it as shared_ptr<const GraphSnapshot>. Taking one from a Graph copies row pointers only.
+using GraphSnapshot = Graph;
+
 class Graph {
 private:
     int numVertices; // Number of vertices in the graph
     bool directed;  // Whether the graph is directed
-    vector<vector<int>> adjList; // Adjacency list: adjList[u] contains neighbors of u
-    void dfs(int v, vector<bool>& visited, const vector<vector<int>>& localAdjList) const;  // DFS used for connectivity check (used in hasEulerCircuit)
+    // Rows are copy-on-write (shared_rows.hpp): copying a Graph shares them, writes go through mut()
+    SharedRows<int> adjList; // Adjacency list: adjList[u] contains neighbors of u
+    SharedRows<int> edgeIdList; // edgeIdList[u][i] is the id of the edge (u, adjList[u][i]), shared by both directions of an undirected edge
+    SharedArray<pair<int, int>> edgeEnds; // Endpoints of every edge id, ids are kept dense in [0, edgeEnds.size())
+
+    // Eulerian feasibility summary, kept up to date by addEdge/removeEdge
+    vector<int> outDeg, inDeg; // Degree counters (undirected graphs only use outDeg)
+    int unbalanced = 0; // Undirected: odd-degree vertices. Directed: vertices with in-degree != out-degree
+    int imbalance = 0; // Sum of |out - in| over directed vertices (equals 'unbalanced' when undirected)
+    vector<int> dsu; // Union-find over the underlying undirected graph, a root stores -(component size)
+    int edgeComponents = 0; // Components that contain at least one edge
+    bool componentsStale = false; // Set by removeEdge: the union-find can't split, it is rebuilt on demand
+
+    void updateDegree(int x, int dOut, int dIn); // Change the degree of x and keep unbalanced/imbalance in sync
+    void rebuildComponents(); // Rebuild dsu/edgeComponents from the edge list
+    int countEdgeComponents(Workspace* ws) const; // edgeComponents, recomputed in ws while the union-find is stale
+    vector<int> hierholzer(int start) const; // Euler trail from start over edge ids
 
 public:
+    // Vertex layouts for relabeled(): identity, by total degree (highest first), reverse Cuthill-McKee, BFS visit order
+    enum class VertexOrder { Original, DegreeDescending, ReverseCuthillMcKee, Bfs };
+
     Graph(int vertices, bool directed = false); // Constructor
     void addEdge(int u, int v); // Add edge between u and v
     void removeEdge(int u, int v); // Remove edge between u and v
@@ -19,15 +62,44 @@ public:
 
     const vector<int>& getNeighbors(int v) const; // Return neighbors of vertex v
     int getNumVertices() const;  // Return total vertices
+    bool isDirected() const; // Whether edges are one-way
 
-    bool hasEulerCircuit() const;// Check if Euler circuit exists
-    vector<int> findEulerCircuit(int start = 0); // Return Euler circuit starting from given vertex
+    // Every algorithm below takes an optional Workspace for its scratch memory, nullptr uses one per thread
+    bool hasEulerCircuit(Workspace* ws = nullptr) const;// Check if Euler circuit exists, O(1) unless edges were removed
+    bool hasEulerPath(Workspace* ws = nullptr) const;// Check if an Euler path (open trail or circuit) exists, same cost as hasEulerCircuit
+    vector<int> findEulerPath() const;// Return an Euler path, from the odd (or out-heavy) vertex when the trail is open
+    // Euler circuit built on 'threads' workers (0 = hardware): closed trails from per-vertex edge pairings, spliced
+    // at shared vertices through a union-find. Valid but not the same circuit as findEulerCircuit. With verify set,
+    // the result is checked with isEulerCircuit and a logic_error is thrown if it fails.
+    vector<int> findEulerCircuitParallel(int start = 0, int threads = 0, bool verify = false) const;
+    bool isEulerCircuit(const vector<int>& circuit) const; // Closed walk that uses every edge exactly once
+    vector<int> findEulerCircuit(int start = 0) const; // Return Euler circuit starting from given vertex, O(V+E)
+    int getNumEdges() const; // Number of edges (an undirected edge counts once)
+    // Graph from CSR arrays (arcs of v are target[offset[v]..offset[v+1]), each row strictly increasing), built in
+    // one pass instead of per-edge addEdge scans. An undirected graph lists both arcs of an edge (invalid_argument
+    // when one is missing), the u < v one is used.
+    static Graph fromCSR(int vertices, bool directed, const uint64_t* offset, const uint32_t* target);
+    // Graph from an edge list in one pass (counting sort into CSR, duplicates dropped), for importers
+    static Graph fromEdges(int vertices, bool directed, const vector<pair<int, int>>& edges);
     static Graph buildRandGraph(int numOfEdges, int numOfVartx, int seed); //Build graph with random edges according to a given number ef edges and vertices
      void removeAllEdges(); //Remove all edges of the graph
+    vector<int> vertexOrder(VertexOrder kind, Workspace* ws = nullptr) const; // order[i] is the vertex placed at position i
+    Graph relabeled(const vector<int>& order) const; // Copy where vertex i is vertex order[i] of this graph
 
     //Algorithm declarations
-    int mstWeight() const;
-    int countCliques();
-    std::vector<std::vector<int>> findSCCs();
-    int maxFlow(int source, int sink);
+    // Totals are summed in Acc (explicitly instantiated for 32 and 64 bit, countCliques also for 16) and throw
+    // overflow_error instead of wrapping.
+    // Once 'stop' fires they return early with a partial result: the tree weight, cliques, components or flow found so far.
+    template <typename Acc = int64_t> Acc mstWeight(Workspace* ws = nullptr, const StopToken* stop = nullptr) const;
+    // Cliques use the rank of each vertex as its order (nullptr: the id), so a relabeled graph can count with its original ids
+    template <typename Acc = uint64_t> Acc countCliques(const vector<int>* rank = nullptr, const StopToken* stop = nullptr) const;
+    std::vector<std::vector<int>> findSCCs(Workspace* ws = nullptr, const StopToken* stop = nullptr) const;
+    // Optionally fills the min cut of the final residual graph
+    int64_t maxFlow(int source, int sink, MinCut* cut = nullptr, Workspace* ws = nullptr);
+    // Max flow for each (source, sink) pair, the residual network is built once and shared by 'threads' workers (0 = hardware)
+    template <typename Acc = int64_t>
+    std::vector<Acc> maxFlows(const std::vector<std::pair<int, int>>& pairs, int threads = 0, Workspace* ws = nullptr,
+                              const StopToken* stop = nullptr) const;
+    // Gusfield's algorithm on an undirected graph, independent flow computations run on 'threads' workers (0 = hardware)
+    GomoryHuTree gomoryHuTree(int threads = 0) const;
 };
@@ -0,0 +1,118 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "stop_token.hpp"
+#include "workspace.hpp"
+
+// Algorithms shared by Graph and CompressedGraph, written once over the adjacency: rows(v) returns the
+// out-neighbors of v as a forward range, however they are stored. Scratch memory comes from the Workspace.
+
+// One vector row as a pointer range, what Graph passes as rows(v)
+struct IntRange {
+    const int* first;
+    const int* last;
+    const int* begin() const { return first; }
+    const int* end() const { return last; }
+};
+
+// Union-find root of x with path halving (a root stores -(size))
+inline int dsuFind(std::vector<int>& dsu, int x) {
+    while (dsu[x] >= 0) {
+        if (dsu[dsu[x]] >= 0) dsu[x] = dsu[dsu[x]];
+        x = dsu[x];
+    }
+    return x;
+}
+
+// Merge the components of u and v (union by size) and keep the number of components with edges,
+// false when they were already one. A component has an edge exactly when it has more than one vertex (no self loops).
+inline bool dsuUnion(std::vector<int>& dsu, int u, int v, int& edgeComponents) {
+    int ru = dsuFind(dsu, u), rv = dsuFind(dsu, v);
+    if (ru == rv) return false;
+    edgeComponents -= (dsu[ru] < -1) + (dsu[rv] < -1);
+    if (dsu[ru] > dsu[rv]) std::swap(ru, rv);
+    dsu[ru] += dsu[rv];
+    dsu[rv] = ru;
+    edgeComponents += 1;
+    return true;
+}
+
+// ---------- Strongly Connected Components (Kosaraju) ----------
+// Both passes run on the explicit stack 'frames' ((vertex, next neighbor in its row)), so deep graphs
+// (long paths) can't overflow the call stack. The reversed graph is built as CSR in the workspace.
+
+// First pass: append every vertex reachable from root to ws.order when it finishes, false when stopped halfway
+template <typename Rows, typename Cursor>
+bool sccFinishOrder(int root, const Rows& rows, std::vector<std::pair<int, Cursor>>& frames, Workspace& ws,
+                    StopPoll& stopped) {
+    frames.clear();
+    ws.visit(root);
+    frames.push_back({root, rows(root).begin()});
+    while (!frames.empty()) {
+        if (stopped()) return false;
+        int v = frames.back().first;
+        Cursor& it = frames.back().second;
+        if (it != rows(v).end()) {
+            int u = *it;
+            ++it;
+            if (!ws.visited(u)) { // 'it' is not used after the push
+                ws.visit(u);
+                frames.push_back({u, rows(u).begin()});
+            }
+        } else {
+            ws.order.push_back(v); // v finished
+            frames.pop_back();
+        }
+    }
+    return true;
+}
+
+// Components in the order the second pass finds them. Stopped in the first pass: none (no component is
+// known before the second one); stopped in the second: the components found so far.
+template <typename Rows, typename Cursor>
+std::vector<std::vector<int>> sccKosaraju(int n, const Rows& rows, std::vector<std::pair<int, Cursor>>& frames,
+                                          Workspace& ws, StopPoll& stopped) {
+    ws.order.clear();
+    ws.begin(n);
+    for (int i = 0; i < n; ++i)
+        if (!ws.visited(i) && !sccFinishOrder(i, rows, frames, ws, stopped)) return {};
+
+    // Reversed graph as CSR in the workspace buffers
+    std::vector<int>& revOffset = ws.revOffset;
+    std::vector<int>& revTarget = ws.revTarget;
+    revOffset.assign(n + 1, 0);
+    for (int u = 0; u < n; ++u)
+        for (int v : rows(u)) revOffset[v + 1]++;
+    for (int v = 0; v < n; ++v) revOffset[v + 1] += revOffset[v];
+    revTarget.resize(revOffset[n]);
+    for (int u = 0; u < n; ++u)
+        for (int v : rows(u)) revTarget[revOffset[v]++] = u; // Uses revOffset[v] as a fill cursor
+    for (int v = n; v > 0; --v) revOffset[v] = revOffset[v - 1]; // Shift the cursors back to offsets
+    revOffset[0] = 0;
+
+    // Second pass on the reversed graph, in reverse finishing order; 'frames' is only a stack here
+    ws.begin(n);
+    std::vector<std::vector<int>> components;
+    for (int k = ws.order.size() - 1; k >= 0 && !stopped(); --k) {
+        int root = ws.order[k];
+        if (ws.visited(root)) continue;
+        std::vector<int> component;
+        frames.clear();
+        ws.visit(root);
+        frames.push_back({root, Cursor()});
+        while (!frames.empty()) {
+            int v = frames.back().first;
+            frames.pop_back();
+            component.push_back(v);
+            for (int a = revOffset[v]; a < revOffset[v + 1]; ++a) {
+                int u = revTarget[a];
+                if (!ws.visited(u)) {
+                    ws.visit(u);
+                    frames.push_back({u, Cursor()});
+                }
+            }
+        }
+        components.push_back(std::move(component));
+    }
+    return components;
+}
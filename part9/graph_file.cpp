@@ -0,0 +1,185 @@
+#include "graph_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 64-bit FNV-1a over 8-byte words (the sections are padded to whole words)
+class Checksum {
+public:
+    void update(const void* data, size_t n) {
+        const char* p = static_cast<const char*>(data);
+        while (n >= 8) {
+            uint64_t w;
+            std::memcpy(&w, p, 8);
+            mix(w);
+            p += 8;
+            n -= 8;
+        }
+        if (n) { // End of a section: the rest of the word is its zero padding
+            uint64_t w = 0;
+            std::memcpy(&w, p, n);
+            mix(w);
+        }
+    }
+    uint64_t value() const { return h; }
+
+private:
+    uint64_t h = 0xcbf29ce484222325ull;
+    void mix(uint64_t w) {
+        h ^= w;
+        h *= 0x100000001b3ull;
+    }
+};
+
+static size_t padded(size_t bytes) { return (bytes + 7) & ~size_t(7); }
+
+// Write 'bytes' followed by zero padding up to a whole word, and hash both
+static void writeSection(std::ofstream& out, Checksum& sum, const void* data, size_t bytes) {
+    static const char zeros[8] = {};
+    out.write(static_cast<const char*>(data), bytes);
+    size_t pad = padded(bytes) - bytes;
+    out.write(zeros, pad);
+    sum.update(data, bytes); // A partial last word is hashed zero padded, as it is on disk
+}
+
+void writeGraphFile(const std::string& path, const Graph& g, const std::vector<int32_t>* weights) {
+    int n = g.getNumVertices();
+    std::vector<uint64_t> offsets(n + 1, 0);
+    std::vector<uint32_t> targets;
+    for (int u = 0; u < n; ++u) {
+        const std::vector<int>& row = g.getNeighbors(u);
+        size_t first = targets.size();
+        targets.insert(targets.end(), row.begin(), row.end());
+        std::sort(targets.begin() + first, targets.end());
+        offsets[u + 1] = targets.size();
+    }
+    if (weights && weights->size() != targets.size()) {
+        throw std::invalid_argument("Error: Expected one weight per arc.\n");
+    }
+
+    GraphFileHeader h{};
+    std::memcpy(h.magic, GraphFileHeader::MAGIC, sizeof(h.magic));
+    h.version = GraphFileHeader::VERSION;
+    h.flags = (g.isDirected() ? GraphFileHeader::FLAG_DIRECTED : 0) | (weights ? GraphFileHeader::FLAG_WEIGHTED : 0);
+    h.numVertices = n;
+    h.numArcs = targets.size();
+    h.offsetsPos = sizeof(GraphFileHeader);
+    h.targetsPos = h.offsetsPos + offsets.size() * sizeof(uint64_t);
+    h.weightsPos = weights ? h.targetsPos + padded(targets.size() * sizeof(uint32_t)) : 0;
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) throw std::system_error(errno, std::generic_category(), "open " + path);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h)); // Rewritten with the checksum below
+    Checksum sum;
+    writeSection(out, sum, offsets.data(), offsets.size() * sizeof(uint64_t));
+    writeSection(out, sum, targets.data(), targets.size() * sizeof(uint32_t));
+    if (weights) writeSection(out, sum, weights->data(), weights->size() * sizeof(int32_t));
+    h.checksum = sum.value();
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+    out.flush();
+    if (!out) throw std::system_error(errno, std::generic_category(), "write " + path);
+}
+
+MappedGraph::MappedGraph(const std::string& path, bool verify) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        int e = errno; ::close(fd);
+        throw std::system_error(e, std::generic_category(), "stat " + path);
+    }
+    size = st.st_size;
+    if (size < sizeof(GraphFileHeader)) {
+        ::close(fd);
+        throw std::invalid_argument("Error: Not a graph file.\n");
+    }
+    void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int e = errno;
+    ::close(fd); // The mapping keeps the file alive
+    if (p == MAP_FAILED) throw std::system_error(e, std::generic_category(), "mmap " + path);
+    base = static_cast<const char*>(p);
+    try {
+        validate(verify);
+    } catch (...) {
+        unmap();
+        throw;
+    }
+}
+
+MappedGraph::~MappedGraph() { unmap(); }
+
+MappedGraph::MappedGraph(MappedGraph&& other) noexcept : base(other.base), size(other.size) {
+    other.base = nullptr;
+    other.size = 0;
+}
+
+MappedGraph& MappedGraph::operator=(MappedGraph&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        std::swap(base, other.base);
+        std::swap(size, other.size);
+    }
+    return *this;
+}
+
+void MappedGraph::unmap() {
+    if (base) ::munmap(const_cast<char*>(base), size);
+    base = nullptr;
+    size = 0;
+}
+
+// Header checks are O(1) and always done, so the accessors never read outside the mapping.
+// The checksum and the per-arc checks read the whole file and only run with 'verify'.
+void MappedGraph::validate(bool verify) const {
+    const GraphFileHeader& h = header();
+    if (std::memcmp(h.magic, GraphFileHeader::MAGIC, sizeof(h.magic)) != 0) {
+        throw std::invalid_argument("Error: Not a graph file.\n");
+    }
+    if (h.version != GraphFileHeader::VERSION) throw std::invalid_argument("Error: Unsupported graph file version.\n");
+    bool weighted = h.flags & GraphFileHeader::FLAG_WEIGHTED;
+    uint64_t targetsEnd = h.targetsPos + padded(h.numArcs * sizeof(uint32_t));
+    uint64_t end = weighted ? h.weightsPos + padded(h.numArcs * sizeof(int32_t)) : targetsEnd;
+    bool layoutOk = h.numVertices <= uint64_t(INT32_MAX) && h.numArcs <= (uint64_t(1) << 40) &&
+                    h.offsetsPos == sizeof(GraphFileHeader) &&
+                    h.targetsPos == h.offsetsPos + (h.numVertices + 1) * sizeof(uint64_t) &&
+                    (!weighted || h.weightsPos == targetsEnd) && end == size;
+    if (!layoutOk) throw std::invalid_argument("Error: Corrupt graph file header.\n");
+    if (offsets()[0] != 0 || offsets()[h.numVertices] != h.numArcs) {
+        throw std::invalid_argument("Error: Corrupt graph file offsets.\n");
+    }
+    if (!verify) return;
+
+    Checksum sum;
+    sum.update(base + sizeof(GraphFileHeader), size - sizeof(GraphFileHeader));
+    if (sum.value() != h.checksum) throw std::invalid_argument("Error: Graph file checksum mismatch.\n");
+    const uint64_t* off = offsets();
+    const uint32_t* tgt = targets();
+    for (uint64_t v = 0; v < h.numVertices; ++v) {
+        if (off[v] > off[v + 1]) throw std::invalid_argument("Error: Corrupt graph file offsets.\n");
+        for (uint64_t a = off[v]; a < off[v + 1]; ++a) {
+            if (tgt[a] >= h.numVertices) throw std::invalid_argument("Error: Corrupt graph file targets.\n");
+        }
+    }
+}
+
+Graph MappedGraph::toGraph() const {
+    return Graph::fromCSR(getNumVertices(), isDirected(), offsets(), targets());
+}
+
+CompressedGraph MappedGraph::toCompressed() const {
+    int n = getNumVertices();
+    CompressedGraph::Builder out(n, isDirected());
+    for (int v = 0; v < n; ++v) {
+        auto [first, last] = neighbors(v);
+        for (const uint32_t* t = first; t != last; ++t) out.addArc(v, static_cast<int>(*t));
+    }
+    return out.finish();
+}
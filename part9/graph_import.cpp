@@ -0,0 +1,329 @@
+#include "graph_import.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const size_t PARALLEL_MIN_BYTES = 4 << 20; // Smaller inputs are parsed on the calling thread
+static const long long MAX_VERTICES = 1 << 20; // A file can't make the Graph allocate more, whatever ids it names
+
+using EdgeList = std::vector<std::pair<int, int>>;
+
+// Thrown by the parsers at the first bad line, turned into a message with the line number by importGraph
+struct BadLine {
+    const char* line;
+    const char* problem = "Malformed input";
+};
+
+// Numbers of one line, separated by spaces or tabs (a trailing '\r' is ignored)
+class Fields {
+public:
+    Fields(const char* p, const char* end) : line(p), p(p), end(end) {}
+    bool next(long long& x) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        if (p == end) return false;
+        auto [ptr, ec] = std::from_chars(p, end, x);
+        if (ec != std::errc() || (ptr < end && *ptr != ' ' && *ptr != '\t' && *ptr != '\r')) throw BadLine{line};
+        p = ptr;
+        return true;
+    }
+    long long require() {
+        long long x;
+        if (!next(x)) throw BadLine{line};
+        return x;
+    }
+    bool empty() {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        return p == end;
+    }
+    char peek() { return empty() ? '\0' : *p; } // First character after the blanks, such as a DIMACS line tag
+    void skipChar() { ++p; }
+    void skipWord() { // A keyword such as the DIMACS problem kind
+        while (p < end && *p != ' ' && *p != '\t') ++p;
+    }
+    const char* line; // Start of the line, for error messages
+
+private:
+    const char* p;
+    const char* end;
+};
+
+// Calls fn(begin, end) for every line of [p, end); memchr finds the newlines (vectorized in libc)
+template <typename Fn>
+static void forEachLine(const char* p, const char* end, Fn&& fn) {
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* e = nl ? nl : end;
+        fn(p, e);
+        p = e + 1;
+    }
+}
+
+static bool isComment(const char* p, const char* e, char mark) { return p < e && *p == mark; }
+
+// Vertex id x of a file whose ids start at 'base', checked against the n vertices of the graph
+static int checkedId(long long x, long long base, long long n, const char* line) {
+    long long id = x - base;
+    if (id < 0 || id >= n) throw BadLine{line, "Invalid vertex index"};
+    return static_cast<int>(id);
+}
+
+// The edge u - v of 'line', Graph has no self loops
+static void addEdge(EdgeList& edges, int u, int v, const char* line) {
+    if (u == v) throw BadLine{line, "Self loop"};
+    edges.push_back({u, v});
+}
+
+// ---------- Per-format chunk parsers: each appends the edges of the lines in [p, end) ----------
+
+static void parseEdgeListChunk(const char* p, const char* end, EdgeList& edges, int& maxId) {
+    forEachLine(p, end, [&](const char* b, const char* e) {
+        Fields f(b, e);
+        if (f.empty() || isComment(b, e, '#') || isComment(b, e, '%')) return;
+        int u = checkedId(f.require(), 0, MAX_VERTICES, b), v = checkedId(f.require(), 0, MAX_VERTICES, b);
+        long long weight;
+        f.next(weight); // Optional, not used by Graph
+        if (!f.empty()) throw BadLine{b};
+        addEdge(edges, u, v, b);
+        maxId = std::max(maxId, std::max(u, v));
+    });
+}
+
+// 'n' is the vertex count of the problem line, which parseDimacsHeader has already read
+static void parseDimacsChunk(const char* p, const char* end, long long n, EdgeList& edges) {
+    forEachLine(p, end, [&](const char* b, const char* e) {
+        Fields f(b, e);
+        switch (f.peek()) {
+        case '\0': return; // Blank line
+        case 'c': return; // Comment
+        case 'n': return; // Source / sink designators of max flow instances
+        case 'a':
+        case 'e': {
+            f.skipChar();
+            int u = checkedId(f.require(), 1, n, b), v = checkedId(f.require(), 1, n, b);
+            long long weight;
+            f.next(weight); // Optional, not used by Graph
+            if (!f.empty()) throw BadLine{b};
+            addEdge(edges, u, v, b);
+            return;
+        }
+        default: throw BadLine{b}; // A second problem line too
+        }
+    });
+}
+
+// Problem line "p <kind> n m", which must come before any arc: returns n, 'body' is the line after it
+static long long parseDimacsHeader(const char* data, const char* end, const char*& body) {
+    const char* p = data;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* e = nl ? nl : end;
+        Fields f(p, e);
+        char tag = f.peek();
+        if (tag != '\0' && tag != 'c') {
+            if (tag != 'p') break;
+            f.skipChar();
+            f.empty();
+            f.skipWord();
+            long long n = f.require();
+            f.require(); // m, the edges are counted from the lines
+            if (n < 0 || !f.empty()) throw BadLine{p};
+            if (n > MAX_VERTICES) throw BadLine{p, "Too many vertices"};
+            body = nl ? nl + 1 : end;
+            return n;
+        }
+        p = e + 1;
+    }
+    throw std::invalid_argument("Error: Missing DIMACS problem line.\n");
+}
+
+struct MetisHeader {
+    long long n = 0;
+    bool sizes = false, vertexWeights = false, edgeWeights = false;
+    long long ncon = 0;
+};
+
+// 'first' is the 0-based vertex of the first non-comment line of the chunk
+static void parseMetisChunk(const char* p, const char* end, const MetisHeader& h, long long first, EdgeList& edges) {
+    long long u = first;
+    forEachLine(p, end, [&](const char* b, const char* e) {
+        if (isComment(b, e, '%')) return;
+        if (u >= h.n) {
+            Fields f(b, e);
+            if (f.empty()) return; // Trailing blank lines
+            throw BadLine{b};
+        }
+        Fields f(b, e);
+        if (h.sizes) f.require();
+        for (long long k = 0; h.vertexWeights && k < h.ncon; ++k) f.require();
+        long long v;
+        while (f.next(v)) {
+            addEdge(edges, static_cast<int>(u), checkedId(v, 1, h.n, b), b);
+            if (h.edgeWeights) f.require();
+        }
+        ++u;
+    });
+}
+
+// Non-comment lines of [p, end) after the METIS header, i.e. vertex lines
+static long long countMetisLines(const char* p, const char* end) {
+    long long count = 0;
+    forEachLine(p, end, [&](const char* b, const char* e) { count += !isComment(b, e, '%'); });
+    return count;
+}
+
+// First non-comment line: "n m [fmt [ncon]]", fmt digits are sizes / vertex weights / edge weights
+static MetisHeader parseMetisHeader(const char* data, const char* end, const char*& body) {
+    MetisHeader h;
+    const char* p = data;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* e = nl ? nl : end;
+        if (!isComment(p, e, '%')) {
+            Fields f(p, e);
+            h.n = f.require();
+            f.require(); // m, the edges are counted from the lines
+            long long fmt = 0;
+            if (f.next(fmt)) {
+                if (fmt < 0 || fmt > 111 || fmt % 10 > 1 || fmt / 10 % 10 > 1) throw BadLine{p};
+                h.sizes = fmt / 100;
+                h.vertexWeights = fmt / 10 % 10;
+                h.edgeWeights = fmt % 10;
+                h.ncon = 1;
+                f.next(h.ncon);
+            }
+            if (h.n < 0 || !f.empty()) throw BadLine{p};
+            if (h.n > MAX_VERTICES) throw BadLine{p, "Too many vertices"};
+            body = nl ? nl + 1 : end;
+            return h;
+        }
+        p = e + 1;
+    }
+    throw std::invalid_argument("Error: Missing METIS header.\n");
+}
+
+// Split [data, end) into 'parts' ranges that start right after a newline
+static std::vector<const char*> splitLines(const char* data, const char* end, int parts) {
+    std::vector<const char*> cuts = {data};
+    size_t size = end - data;
+    for (int i = 1; i < parts; ++i) {
+        const char* c = std::max(cuts.back(), data + size * i / parts);
+        const char* nl = static_cast<const char*>(std::memchr(c, '\n', end - c));
+        cuts.push_back(nl ? nl + 1 : end);
+    }
+    cuts.push_back(end);
+    return cuts;
+}
+
+// Run fn(i) for i in [0, parts) on one thread each, rethrowing the first failure
+template <typename Fn>
+static void runParts(int parts, Fn&& fn) {
+    if (parts == 1) {
+        fn(0);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(parts);
+    std::vector<std::thread> pool;
+    for (int i = 0; i < parts; ++i) {
+        pool.emplace_back([&, i] {
+            try {
+                fn(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+    for (auto& e : errors)
+        if (e) std::rethrow_exception(e);
+}
+
+Graph importGraph(const char* data, size_t size, GraphFormat format, bool directed, int threads) {
+    const char* end = data + size;
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    if (size < PARALLEL_MIN_BYTES) threads = 1;
+
+    try {
+        const char* body = data;
+        MetisHeader header;
+        long long vertices = 0; // DIMACS: from the problem line
+        if (format == GraphFormat::Metis) header = parseMetisHeader(data, end, body);
+        if (format == GraphFormat::Dimacs) vertices = parseDimacsHeader(data, end, body);
+        std::vector<const char*> cuts = splitLines(body, end, threads);
+        int parts = cuts.size() - 1;
+        std::vector<EdgeList> edges(parts);
+        std::vector<int> maxIds(parts, -1);
+        std::vector<long long> firstVertex(parts + 1, 0);
+
+        if (format == GraphFormat::Metis) { // Vertex of each chunk's first line: prefix sum of line counts
+            runParts(parts, [&](int i) { firstVertex[i + 1] = countMetisLines(cuts[i], cuts[i + 1]); });
+            for (int i = 0; i < parts; ++i) firstVertex[i + 1] += firstVertex[i];
+        }
+        runParts(parts, [&](int i) {
+            switch (format) {
+            case GraphFormat::EdgeList: parseEdgeListChunk(cuts[i], cuts[i + 1], edges[i], maxIds[i]); break;
+            case GraphFormat::Dimacs: parseDimacsChunk(cuts[i], cuts[i + 1], vertices, edges[i]); break;
+            case GraphFormat::Metis: parseMetisChunk(cuts[i], cuts[i + 1], header, firstVertex[i], edges[i]); break;
+            }
+        });
+
+        long long n = 0;
+        if (format == GraphFormat::EdgeList) n = *std::max_element(maxIds.begin(), maxIds.end()) + 1;
+        if (format == GraphFormat::Metis) n = header.n;
+        if (format == GraphFormat::Dimacs) n = vertices;
+        EdgeList all;
+        if (parts == 1) {
+            all = std::move(edges[0]);
+        } else {
+            size_t total = 0;
+            for (const auto& e : edges) total += e.size();
+            all.reserve(total);
+            for (auto& e : edges) {
+                all.insert(all.end(), e.begin(), e.end());
+                EdgeList().swap(e);
+            }
+        }
+        return Graph::fromEdges(static_cast<int>(n), directed, all);
+    } catch (const BadLine& bad) {
+        long long line = 1 + std::count(data, bad.line, '\n');
+        throw std::invalid_argument("Error: " + std::string(bad.problem) + " at line " + std::to_string(line) + ".\n");
+    }
+}
+
+Graph importGraphFile(const std::string& path, GraphFormat format, bool directed, int threads) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::system_error(errno, std::generic_category(), "open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) < 0) {
+        int e = errno; ::close(fd);
+        throw std::system_error(e, std::generic_category(), "stat " + path);
+    }
+    size_t size = st.st_size;
+    if (size == 0) {
+        ::close(fd);
+        return importGraph("", 0, format, directed, threads);
+    }
+    void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int e = errno;
+    ::close(fd);
+    if (p == MAP_FAILED) throw std::system_error(e, std::generic_category(), "mmap " + path);
+    ::madvise(p, size, MADV_SEQUENTIAL);
+    try {
+        Graph g = importGraph(static_cast<const char*>(p), size, format, directed, threads);
+        ::munmap(p, size);
+        return g;
+    } catch (...) {
+        ::munmap(p, size);
+        throw;
+    }
+}
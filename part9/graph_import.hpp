@@ -0,0 +1,21 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "graph.hpp"
+
+// Text graph formats read by importGraph:
+//   EdgeList  "u v [weight]" per line, 0-based ids, '#' or '%' starts a comment, n = largest id + 1
+//   Dimacs    "p <kind> n m" first, then "a u v [w]" or "e u v [w]" lines, 1-based ids, 'c' starts a comment
+//   Metis     "n m [fmt [ncon]]" then line i lists the (1-based) neighbors of vertex i, '%' starts a comment;
+//             fmt 1x/x1 adds vertex weights (ncon per vertex) / a weight after every neighbor, both skipped
+enum class GraphFormat { EdgeList, Dimacs, Metis };
+
+// Parse a text graph held in memory. Lines are found with memchr and numbers read with std::from_chars;
+// inputs of at least a few MB are split at line boundaries and parsed on 'threads' workers (0 = hardware).
+// The edges are gathered first and the Graph is built in one pass (Graph::fromEdges), duplicates dropped.
+// Malformed input, self loops, out of range ids and graphs of more than 2^20 vertices throw invalid_argument
+// naming the line (for an edge list, the first id of 2^20 or more).
+Graph importGraph(const char* data, size_t size, GraphFormat format, bool directed = false, int threads = 0);
+
+// Same, for a file mapped with mmap (no read copies)
+Graph importGraphFile(const std::string& path, GraphFormat format, bool directed = false, int threads = 0);
@@ -1,31 +1,295 @@
 #include "pipling.hpp"
+#include "workspace.hpp"
+#include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+// Worker counts (1..256 per stage), queue capacity and batch size of a Config, checked before the queues are allocated
+static const Pipling::Config& checkConfig(const Pipling::Config& config) {
+    for (int w : config.workers) {
+        if (w < 1 || w > 256) throw std::invalid_argument("Error: Invalid number of stage workers.\n");
+    }
+    if (config.queueCapacity < 1 || config.queueCapacity > (1u << 20)) {
+        throw std::invalid_argument("Error: Invalid Pipling queue capacity.\n");
+    }
+    if (config.maxBatch < 1 || config.maxBatch > 4096) {
+        throw std::invalid_argument("Error: Invalid Pipling batch size.\n");
+    }
+    return config;
+}
+
 //Constractor
-Pipling::Pipling() {}
+Pipling::Pipling(Graph::VertexOrder order) { config.order = order; }
+Pipling::Pipling(const Config& config) : config(checkConfig(config)) {}
+
+Pipling::Config Pipling::Config::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::invalid_argument("Error: Can't read Pipling config " + path + ".\n");
+    Config c;
+    std::string line;
+    int lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        std::string key, value, extra;
+        if (!(fields >> key)) continue; // Blank or comment
+        bool ok = static_cast<bool>(fields >> value) && !(fields >> extra);
+        const char* stages[STAGES] = {"mst", "cliques", "scc", "flow"};
+        int stage = -1;
+        for (int s = 0; s < STAGES; ++s) if (key == stages[s]) stage = s;
+        if (ok && stage >= 0) {
+            try {
+                size_t used;
+                c.workers[stage] = std::stoi(value, &used);
+                ok = used == value.size();
+            } catch (const std::exception&) {
+                ok = false;
+            }
+        } else if (ok && key == "order") {
+            if (value == "original") c.order = Graph::VertexOrder::Original;
+            else if (value == "degree") c.order = Graph::VertexOrder::DegreeDescending;
+            else if (value == "rcm") c.order = Graph::VertexOrder::ReverseCuthillMcKee;
+            else if (value == "bfs") c.order = Graph::VertexOrder::Bfs;
+            else ok = false;
+        } else if (ok && key == "overflow") {
+            if (value == "block") c.overflow = Overflow::Block;
+            else if (value == "reject") c.overflow = Overflow::Reject;
+            else if (value == "drop_oldest") c.overflow = Overflow::DropOldest;
+            else ok = false;
+        } else if (ok && key == "adaptive") {
+            if (value == "on" || value == "off") c.adaptive = value == "on";
+            else ok = false;
+        } else if (ok && key == "queue_capacity") {
+            try {
+                size_t used;
+                c.queueCapacity = std::stoul(value, &used);
+                ok = used == value.size() && value[0] != '-';
+            } catch (const std::exception&) {
+                ok = false;
+            }
+        } else if (ok && key == "max_batch") {
+            try {
+                size_t used;
+                c.maxBatch = std::stoul(value, &used);
+                ok = used == value.size() && value[0] != '-';
+            } catch (const std::exception&) {
+                ok = false;
+            }
+        } else if (ok && key == "job_timeout_ms") {
+            try {
+                size_t used;
+                long ms = std::stol(value, &used);
+                ok = used == value.size() && ms >= 0;
+                c.jobTimeout = std::chrono::milliseconds(ms);
+            } catch (const std::exception&) {
+                ok = false;
+            }
+        } else if (ok && key == "rebalance_ms") {
+            try {
+                size_t used;
+                int ms = std::stoi(value, &used);
+                ok = used == value.size() && ms >= 1 && ms <= 60000;
+                c.rebalancePeriod = std::chrono::milliseconds(ms);
+            } catch (const std::exception&) {
+                ok = false;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) throw std::invalid_argument("Error: Malformed Pipling config at line " + std::to_string(lineNo) + ".\n");
+    }
+    checkConfig(c);
+    return c;
+}
 //Distractor
 Pipling::~Pipling(){ stop(); }
 
-// Acuator 4 threads
+// Acuator the stage workers: a job fans out to all stages and joins when the last one finishes,
+// so its latency is the slowest algorithm rather than the sum of the four
 void Pipling::start(){
-    t1 = std::thread([this]{ stage1(); });
-    t2 = std::thread([this]{ stage2(); });
-    t3 = std::thread([this]{ stage3(); });
-    t4 = std::thread([this]{ stage4(); });
+    std::lock_guard<std::mutex> lk(monitorMutex);
+    stopping = false; // Set by an earlier stop(), the monitor of a restarted pipeline must run again
+    for (auto& m : moves) m = {};
+    assigned = config.workers;
+    for (int s = 0; s < STAGES; ++s)
+        for (int w = 0; w < config.workers[s]; ++w) threads.emplace_back(&Pipling::worker, this, s);
+    if (config.adaptive) monitorThread = std::thread([this]{ monitor(); });
 }
 
 // Close safty all threads
 void Pipling::stop(){
-    q1.push(nullptr);
-    if (t1.joinable()) t1.join();
-    if (t2.joinable()) t2.join();
-    if (t3.joinable()) t3.join();
-    if (t4.joinable()) t4.join();
+    {
+        std::lock_guard<std::mutex> lk(monitorMutex);
+        stopping = true;
+    }
+    monitorCv.notify_all();
+    if (monitorThread.joinable()) monitorThread.join();
+    // One sentinel per worker, a worker still on its way to another stage finds its token first
+    for (int s = 0; s < STAGES; ++s)
+        for (int w = 0; w < assigned[s]; ++w) queue(s).push(nullptr);
+    for (auto& t : threads) if (t.joinable()) t.join();
+    threads.clear();
+    assigned = {};
+    qout.push(nullptr);
+}
+
+std::array<int, Pipling::STAGES> Pipling::workerCounts() const {
+    std::lock_guard<std::mutex> lk(monitorMutex);
+    return assigned;
+}
+
+RingQueue<Pipling::JobPtr>& Pipling::queue(int stage){
+    RingQueue<JobPtr>* queues[STAGES] = {&q1, &q2, &q3, &q4};
+    return *queues[stage];
+}
+
+// Receives and streams a graph for processing, push job to every selected stage
+uint64_t Pipling::submit(const Graph& g, std::vector<std::pair<int, int>> flowPairs, Completion done,
+                         JobOptions options){
+    // O(V) pointer copies, rows are shared
+    return submit(std::make_shared<const GraphSnapshot>(g), std::move(flowPairs), std::move(done), options);
+}
+
+uint64_t Pipling::submit(Graph&& g, std::vector<std::pair<int, int>> flowPairs, Completion done, JobOptions options){
+    return submit(std::make_shared<const GraphSnapshot>(std::move(g)), std::move(flowPairs), std::move(done), options);
 }
 
-// Receives and streams a graph for processing, push job to q1
-void Pipling::submit(const Graph& g){
-    // transfer graph to constractor
-    auto job = std::make_shared<Job>(g); 
-    q1.push(std::move(job));
+Pipling::Ticket Pipling::submitAsync(Graph g, std::vector<std::pair<int, int>> flowPairs, JobOptions options){
+    // Shared by the callback and this frame, so the promise outlives whichever finishes last
+    auto promise = std::make_shared<std::promise<Result>>();
+    Ticket ticket;
+    ticket.result = promise->get_future();
+    ticket.id = submit(std::move(g), std::move(flowPairs), [promise](Result r) { promise->set_value(std::move(r)); },
+                       options);
+    return ticket;
+}
+
+uint64_t Pipling::submit(std::shared_ptr<const GraphSnapshot> g, std::vector<std::pair<int, int>> flowPairs,
+                     Completion done, JobOptions options){
+    if (options.algorithms == 0 || options.algorithms > ALL_ALGORITHMS) {
+        throw std::invalid_argument("Error: Invalid algorithm selection.\n");
+    }
+    int n = g->getNumVertices();
+    if (flowPairs.empty() && n > 0) flowPairs.push_back({0, n - 1});
+    for (const auto& [s, t] : flowPairs) {
+        if (s < 0 || s >= n || t < 0 || t >= n) {
+            throw std::invalid_argument("Error: Invalid flow source or sink.\n");
+        }
+    }
+    if (options.deadline == StopToken::Clock::time_point::max() && config.jobTimeout.count() > 0) {
+        options.deadline = StopToken::Clock::now() + config.jobTimeout;
+    }
+    admit();
+    JobPtr job;
+    try {
+        // transfer graph to constractor
+        job = std::make_shared<Job>(std::move(g), options.order.value_or(config.order), options.deadline, std::move(options.cancel));
+    } catch (...) {
+        release();
+        throw;
+    }
+    job->result.flow_pairs = std::move(flowPairs);
+    job->result.algorithms = options.algorithms;
+    job->pending.store(__builtin_popcount(options.algorithms), std::memory_order_relaxed);
+    job->done = std::move(done);
+    if (!job->done) job->outSeq = ++lastOutSeq;
+    uint64_t id = job->result.job_id = ++lastId;
+    if (config.overflow == Overflow::DropOldest) {
+        std::lock_guard<std::mutex> lk(admitMutex);
+        while (!admitted.empty()) { // Forget jobs at the front that started or finished
+            JobPtr front = admitted.front().lock();
+            if (front && front->state.load(std::memory_order_relaxed) == Job::Queued) break;
+            admitted.pop_front();
+        }
+        admitted.push_back(job);
+    }
+    for (int s = 0; s < STAGES; ++s) // Only the selected stages see the job
+        if (options.algorithms & (1u << s)) enqueue(s, job);
+    return id;
+}
+
+// Under DropOldest a stage busy on a long job keeps the jobs dropped behind it in its ring, and an endless stream of
+// submits would fill any size. So the submitter that finds the ring full empties it: dropped jobs are counted down
+// here as the stage would have (the last count delivers them, possibly on this thread), the rest go back in order.
+// Live jobs and control items are at most queueCapacity plus a few, so at least half the ring comes free.
+void Pipling::enqueue(int stage, const JobPtr& job){
+    JobPtr item = job;
+    if (config.overflow != Overflow::DropOldest) {
+        queue(stage).push(std::move(item));
+        return;
+    }
+    std::vector<JobPtr> kept, completed;
+    while (!queue(stage).tryPush(item)) {
+        JobPtr j;
+        while (queue(stage).tryPop(j)) {
+            bool dropped = j && j != migrateToken && j->state.load(std::memory_order_relaxed) == Job::Dropped;
+            if (!dropped) kept.push_back(std::move(j));
+            else if (finish(j)) completed.push_back(std::move(j));
+        }
+        for (JobPtr& k : kept) queue(stage).push(std::move(k)); // Room for them: they were just taken out
+        kept.clear();
+    }
+    if (!completed.empty()) deliver(completed);
+}
+
+void Pipling::admit(){
+    std::unique_lock<std::mutex> lk(admitMutex);
+    while (inFlight >= config.queueCapacity) {
+        if (config.overflow == Overflow::Reject) {
+            lk.unlock();
+            throw Saturated(retryAfter());
+        }
+        if (config.overflow == Overflow::DropOldest && dropOldest()) break;
+        admitCv.wait(lk);
+    }
+    ++inFlight;
+}
+
+// Called with admitMutex held. Entries of jobs that started or finished are discarded on the way.
+bool Pipling::dropOldest(){
+    while (!admitted.empty()) {
+        JobPtr j = admitted.front().lock();
+        admitted.pop_front();
+        int expected = Job::Queued;
+        // Only the state is written here: the stages skipping the job own its other fields, see finish()
+        if (j && j->state.compare_exchange_strong(expected, Job::Dropped)) {
+            --inFlight;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Pipling::release(){
+    {
+        std::lock_guard<std::mutex> lk(admitMutex);
+        --inFlight;
+    }
+    admitCv.notify_all();
+}
+
+void Pipling::waitForRoom(){
+    if (config.overflow != Overflow::Block) return;
+    std::unique_lock<std::mutex> lk(admitMutex);
+    admitCv.wait(lk, [this]{ return inFlight < config.queueCapacity; });
+}
+
+size_t Pipling::inFlightJobs() const {
+    std::lock_guard<std::mutex> lk(admitMutex);
+    return inFlight;
+}
+
+// Slowest stage: its queue depth times its service time, shared by its workers
+std::chrono::milliseconds Pipling::retryAfter(){
+    std::array<int, STAGES> workers = workerCounts();
+    double ns = 0;
+    for (int s = 0; s < STAGES; ++s) {
+        double stage = double(queue(s).size()) * serviceNs[s].load(std::memory_order_relaxed) / std::max(1, workers[s]);
+        ns = std::max(ns, stage);
+    }
+    return std::chrono::milliseconds(std::max<int64_t>(1, static_cast<int64_t>(ns / 1e6)));
 }
 
 // Wait for final result
@@ -36,47 +300,179 @@ Pipling::Result Pipling::get(){
     }
 }
 
-//Pop a Job from q1, compute MST weight, push to q2 graph and result (job) stop on sentinel.
-void Pipling::stage1(){
-    for(;;){
-        // wait for next item from q1
-        JobPtr j = q1.pop();
-        // got sentinel: forward it to q2 and exit this stage
-        if (!j){ q2.push(nullptr); break; }
-        j->result.mst_weight = j->graph.mstWeight();
-        q2.push(std::move(j));
+// Fan-in: the stage that finishes a job last hands it to its callback, or to qout in submission order
+bool Pipling::finish(JobPtr& j){
+    // acq_rel: the last stage sees the result fields written by the others
+    if (j->pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return false;
+    if (j->state.load(std::memory_order_relaxed) == Job::Dropped) { // Gave its slot back when dropped
+        j->result.status = Status::Dropped;
+        j->graph.reset(); // No stage reads it any more, free the memory before the job is delivered
+        j->small.reset();
+    } else {
+        release();
+    }
+    switch (j->interrupted.load(std::memory_order_relaxed)) {
+    case StopToken::Reason::Cancelled: j->result.status = Status::Cancelled; break;
+    case StopToken::Reason::Expired: j->result.status = Status::TimedOut; break;
+    case StopToken::Reason::None: break;
     }
+    if (j->done) {
+        j->done(std::move(j->result));
+        return false;
+    }
+    return true;
 }
 
-//Pop a Job from q2, count cliques, push to q3 graph and result (job) stop on sentinel.
-void Pipling::stage2(){
-    for(;;){
-        JobPtr j = q2.pop();
-        // got sentinel: forward it to q3 and exit this stage
-        if (!j){ q3.push(nullptr); break; }
-        j->result.num_cliques = j->graph.countCliques();
-        q3.push(std::move(j));
+// Jobs that finished ahead of an earlier one wait in 'parked'; the run that is now in order goes to qout at once
+void Pipling::deliver(std::vector<JobPtr>& jobs){
+    std::lock_guard<std::mutex> lk(outMutex);
+    for (JobPtr& j : jobs) parked.emplace(j->outSeq, std::move(j));
+    jobs.clear();
+    while (!parked.empty() && parked.begin()->first == delivered + 1) {
+        jobs.push_back(std::move(parked.begin()->second));
+        parked.erase(parked.begin());
+        ++delivered;
     }
+    if (!jobs.empty()) qout.pushAll(jobs); // Still under outMutex, so runs from different workers keep their order
+    jobs.clear();
 }
 
-//Pop a Job from q3, find SCCs, push to q4 graph and result (job) stop on sentinel.
-void Pipling::stage3(){
+// A fair share of the stage's backlog: with several workers on a stage, one of them taking the whole queue would
+// leave the others idle while its batch waits behind itself. Jobs in a batch are also hidden from the monitor and
+// from workers moved to the stage, so a batch is kept to BATCH_NS of work (1 until the service time is known).
+size_t Pipling::batchSize(int stage){
+    size_t workers = std::max(1, serving[stage].load(std::memory_order_relaxed));
+    int64_t service = serviceNs[stage].load(std::memory_order_relaxed);
+    size_t limit = std::min<size_t>(config.maxBatch, service > 0 ? BATCH_NS / service : 1);
+    return std::clamp<size_t>(queue(stage).size() / workers, 1, std::max<size_t>(limit, 1));
+}
+
+//Pop Jobs from the stage's queue and run them, stop on sentinel. A migrate token moves the worker to another stage.
+//Jobs come in batches when the queue is deep: one wake-up for the batch, one clock read for its service time,
+//and the jobs of the batch that complete are delivered to get() together.
+void Pipling::worker(int stage){
+    Workspace ws; // Scratch buffers reused by every job of this worker, whichever stage it serves
+    std::vector<JobPtr> batch, completed;
+    auto control = [this](const JobPtr& j) { return !j || j == migrateToken; }; // Always the last of a batch
+    serving[stage].fetch_add(1, std::memory_order_relaxed);
     for(;;){
-        JobPtr j = q3.pop();
-        // got sentinel: forward it to q4 and exit this stage
-        if (!j){ q4.push(nullptr); break; }
-        j->result.sccs = j->graph.findSCCs();
-        q4.push(std::move(j));
+        queue(stage).popBatch(batch, batchSize(stage), control);
+        bool sentinel = !batch.back(), migrate = batch.back() == migrateToken;
+        if (sentinel || migrate) batch.pop_back();
+        int ran = 0;
+        auto begin = std::chrono::steady_clock::now();
+        for (JobPtr& j : batch) {
+            int expected = Job::Queued;
+            bool dropped = !j->state.compare_exchange_strong(expected, Job::Running) && expected == Job::Dropped;
+            // Dropped, cancelled or expired while queued: skipped, it still counts down so the last stage delivers it
+            if (!dropped && !interrupted(*j)) {
+                runStage(stage, *j, ws);
+                interrupted(*j); // The algorithm may have returned early
+                ++ran;
+            }
+            if (finish(j)) completed.push_back(std::move(j));
+        }
+        batch.clear(); // Don't keep graphs alive while waiting for the next batch
+        if (ran) {
+            int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count() / ran;
+            int64_t avg = serviceNs[stage].load(std::memory_order_relaxed); // Racy update, it is only a hint
+            serviceNs[stage].store(avg ? avg + (ns - avg) / 8 : ns, std::memory_order_relaxed);
+        }
+        if (!completed.empty()) deliver(completed);
+        if (sentinel) break; // got sentinel: exit this worker
+        if (migrate) {
+            std::lock_guard<std::mutex> lk(monitorMutex);
+            int to = moves[stage].front();
+            moves[stage].pop();
+            serving[stage].fetch_sub(1, std::memory_order_relaxed);
+            serving[to].fetch_add(1, std::memory_order_relaxed);
+            stage = to;
+        }
     }
+    serving[stage].fetch_sub(1, std::memory_order_relaxed);
 }
 
-//Pop a Job from q4, computes max flow, push to qout graph and result (job) stop on sentinel.
-void Pipling::stage4(){
-    for(;;){
-        JobPtr j = q4.pop();
-        // got sentinel: forward it to qout and exit this stage
-        if (!j){ qout.push(nullptr); break; }
-        j->result.max_flow = j->graph.maxFlow(0, j->graph.getNumVertices() - 1);
-        qout.push(std::move(j));
+// The reason is kept even if the stage finished just before the token fired, so a Cancelled or TimedOut
+// result may well be complete; it is only promised to be no more than partial
+bool Pipling::interrupted(Job& j){
+    StopToken::Reason r = j.stop.reason();
+    if (r == StopToken::Reason::None) return false;
+    StopToken::Reason none = StopToken::Reason::None;
+    j.interrupted.compare_exchange_strong(none, r, std::memory_order_relaxed); // Read by finish() after acq_rel
+    return true;
+}
+
+// Bitmask graphs are small enough for every algorithm but cliques to finish in microseconds, only that one polls
+void Pipling::runStage(int stage, Job& j, Workspace& ws){
+    switch (stage) {
+    case Mst:
+        j.result.mst_weight = j.small ? j.small->mstWeight() : j.graph->mstWeight(&ws, &j.stop);
+        break;
+    case Cliques: {
+        // Clique order follows the client ids, which matters for directed graphs
+        const std::vector<int>* rank = j.order.empty() ? nullptr : &j.order;
+        j.result.num_cliques = j.small ? j.small->countCliques(&j.stop) : j.graph->countCliques(rank, &j.stop);
+        break;
+    }
+    case Scc:
+        j.result.sccs = j.small ? j.small->findSCCs() : j.graph->findSCCs(&ws, &j.stop);
+        if (!j.order.empty()) { // Back to client ids
+            for (auto& comp : j.result.sccs)
+                for (int& v : comp) v = j.order[v];
+        }
+        // The bitmask path and the layouts each list components in their own order, clients get one order
+        for (auto& comp : j.result.sccs) std::sort(comp.begin(), comp.end());
+        std::sort(j.result.sccs.begin(), j.result.sccs.end());
+        break;
+    case Flow: {
+        // One residual network for all requested pairs, computed on this worker alone: the parallelism of the
+        // pipeline is its stage workers (Config::workers), a thread pool per request would compete with them
+        std::vector<std::pair<int, int>> pairs = j.result.flow_pairs;
+        if (!j.order.empty()) { // Client ids to the relabeled vertices, flow values don't depend on labels
+            for (auto& [s, t] : pairs) { s = j.position[s]; t = j.position[t]; }
+        }
+        j.result.max_flows = j.small ? j.small->maxFlows(pairs) : j.graph->maxFlows(pairs, 1, &ws, &j.stop);
+        if (!j.result.max_flows.empty()) j.result.max_flow = j.result.max_flows.front();
+        break;
+    }
+    }
+}
+
+// Every rebalancePeriod: the expected wait at each stage is its queue depth times the service time shared by its
+// workers. One worker moves from the least to the most loaded stage when the gap is wide (more than twice plus a
+// period) and the same pair stood out on three samples in a row, so short bursts don't shuffle threads around.
+void Pipling::monitor(){
+    const int HOLD = 3;
+    const double floorNs = std::chrono::duration_cast<std::chrono::nanoseconds>(config.rebalancePeriod).count();
+    int streak = 0, lastFrom = -1, lastTo = -1;
+    std::unique_lock<std::mutex> lk(monitorMutex);
+    while (!monitorCv.wait_for(lk, config.rebalancePeriod, [this]{ return stopping; })) {
+        double wait[STAGES];
+        for (int s = 0; s < STAGES; ++s)
+            wait[s] = double(queue(s).size()) * serviceNs[s].load(std::memory_order_relaxed) / assigned[s];
+        int to = 0, from = -1;
+        for (int s = 1; s < STAGES; ++s) if (wait[s] > wait[to]) to = s;
+        for (int s = 0; s < STAGES; ++s)
+            if (s != to && assigned[s] > 1 && (from < 0 || wait[s] < wait[from])) from = s;
+        if (from < 0 || wait[to] <= 2 * wait[from] + floorNs) {
+            streak = 0;
+            continue;
+        }
+        streak = (from == lastFrom && to == lastTo) ? streak + 1 : 1;
+        lastFrom = from;
+        lastTo = to;
+        if (streak < HOLD) continue;
+        streak = 0;
+        --assigned[from];
+        ++assigned[to];
+        // Under monitorMutex, so tokens and moves stay in the same order. Never waits for room: the workers
+        // popping an earlier token need the mutex, a full queue just skips this round.
+        JobPtr token = migrateToken;
+        if (!queue(from).tryPush(token)) {
+            ++assigned[from];
+            --assigned[to];
+            continue;
+        }
+        moves[from].push(to);
     }
 }
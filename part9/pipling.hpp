@@ -5,38 +5,166 @@
 #include <thread>
 #include <memory>
 #include <vector>
+#include <optional>
+#include <map>
+#include <deque>
+#include <stdexcept>
+#include <functional>
+#include <future>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <string>
 #include "graph.hpp"
+#include "smallgraph.hpp"
+#include "ring_queue.hpp"
+#include "stop_token.hpp"
+
+// Per-job choices for Pipling::submit
+struct JobOptions {
+    // Bit (1 << Pipling::Stage) for each algorithm to run. The job is only queued on those stages, so a cheap
+    // query never waits behind clique counts it didn't ask for.
+    unsigned algorithms = 0xF;
+    // Stages stop working on the job once the deadline passes (max: Config::jobTimeout applies) or 'cancel' is
+    // cancelled; one token may be shared by many jobs, e.g. all the requests of a client
+    StopToken::Clock::time_point deadline = StopToken::Clock::time_point::max();
+    std::shared_ptr<const StopToken> cancel;
+    // Layout for this job, unset: Pipling::Config::order. Relabeling copies the graph (O(E log E)) on the submitting
+    // thread, so it only pays for graphs whose algorithms run long enough to profit from the better locality.
+    std::optional<Graph::VertexOrder> order;
+};
 
 class Pipling {
 public:
+    static constexpr int STAGES = 4; // MST, cliques, SCCs, max flow
+    enum Stage { Mst, Cliques, Scc, Flow };
+    static constexpr unsigned ALL_ALGORITHMS = (1u << STAGES) - 1;
+
+    // Dropped: evicted unstarted by a newer job (Overflow::DropOldest). Cancelled / TimedOut: the job's token fired
+    // while it was queued or running, stages cut short hold partial values and stages not reached keep the defaults.
+    enum class Status { Done, Dropped, Cancelled, TimedOut };
+
     //Stract for saving all algorithms results that activated by all threds
     struct Result {
-        int mst_weight = -1;
-        int num_cliques = -1;
-        std::vector<std::vector<int>> sccs;
-        int max_flow = -1;
+        uint64_t job_id = 0; // Id returned by submit for this job
+        Status status = Status::Done; // The algorithm fields are only filled in when Done
+        unsigned algorithms = ALL_ALGORITHMS; // JobOptions::algorithms, the fields of the others keep their defaults
+        int64_t mst_weight = -1;
+        uint64_t num_cliques = 0;
+        std::vector<std::vector<int>> sccs; // Each component in increasing order, components by lowest vertex
+        int64_t max_flow = -1; // Flow of the first requested pair
+        std::vector<std::pair<int, int>> flow_pairs; // (source, sink) pairs that were computed
+        std::vector<int64_t> max_flows; // max_flows[i] is the flow of flow_pairs[i]
+    };
+
+    // Called on the last stage's thread with the finished result, instead of queuing it for get(); must not throw
+    using Completion = std::function<void(Result)>;
+
+    // Handle of a job submitted with submitAsync: its id and the future that receives exactly its result
+    struct Ticket {
+        uint64_t id = 0;
+        std::future<Result> result;
+    };
+
+    // What submit does when queueCapacity jobs are already in flight: wait for one to finish, throw Saturated,
+    // or drop the oldest job no stage has started yet (it completes with Status::Dropped; waits when all started)
+    enum class Overflow { Block, Reject, DropOldest };
+
+    // Thrown by submit under Overflow::Reject, with a guess of when a slot frees up from the stages' service times
+    struct Saturated : std::runtime_error {
+        std::chrono::milliseconds retryAfter;
+        explicit Saturated(std::chrono::milliseconds retryAfter)
+            : std::runtime_error("Error: Pipeline saturated, retry later.\n"), retryAfter(retryAfter) {}
     };
 
-    Pipling(); //Constractor
+    struct Config {
+        // Graphs above SmallGraph size are relabeled to 'order' before the stages run, results keep the client ids.
+        // Default layout of the jobs, JobOptions::order sets it per job.
+        Graph::VertexOrder order = Graph::VertexOrder::Original;
+        // Threads pulling from each stage's queue, indexed by Stage. Jobs then finish out of order: callbacks and
+        // futures get them as they complete, get() still returns them in submission order.
+        std::array<int, STAGES> workers = {1, 1, 1, 1};
+        // Let a monitor move workers between stages, keeping their total (the sum of 'workers'): every period it
+        // compares the backlog of each stage (queue depth x service time / workers) and moves one worker from the
+        // least to the most loaded stage once the gap has held for a few samples. Every stage keeps one worker.
+        bool adaptive = false;
+        std::chrono::milliseconds rebalancePeriod{20};
+        // Jobs admitted at once (at most 2^20); the stage queues are sized from it. Under DropOldest dropped jobs stay
+        // queued until their stages skip them, a submitter that finds a queue full clears them out instead of waiting.
+        size_t queueCapacity = 1024;
+        Overflow overflow = Overflow::Block;
+        // Deadline of a job submitted without one, counted from submit (0: none)
+        std::chrono::milliseconds jobTimeout{0};
+        // Most jobs a worker takes per wake-up (1..4096, 1: one at a time). The batch is its share of the queue
+        // (depth / workers of the stage), so it is 1 at light load and only grows when jobs pile up, and no more
+        // than the stage serves in about BATCH_NS: only cheap stages batch, a slow one keeps its backlog in the queue.
+        size_t maxBatch = 32;
+        // Read "key value" lines ('#' starts a comment): mst/cliques/scc/flow <threads>, order original|degree|rcm|bfs,
+        // adaptive on|off, rebalance_ms <ms>, queue_capacity <jobs>, overflow block|reject|drop_oldest, job_timeout_ms <ms>,
+        // max_batch <jobs>.
+        // Keys left out keep their defaults.
+        static Config load(const std::string& path);
+    };
+
+    explicit Pipling(Graph::VertexOrder order = Graph::VertexOrder::Original); //Constractor
+    explicit Pipling(const Config& config);
     ~Pipling(); //Distractor
-    void start();                  // Acuator 4 threads
+    void start();                  // Acuator the worker threads of every stage
     void stop();                   // Close safty all threads
-    void submit(const Graph& g);   // Receives and streams a graph for processing
-    Result get();                  // Wait for final result
+    // Receives and streams a graph for processing, max flow is computed for every (source, sink) pair (default: 0 -> n-1)
+    // The job keeps a snapshot, so the caller may go on editing g: copying shares its rows (copy-on-write).
+    // With 'done' the result goes to that callback, so any number of threads can share one started pipeline.
+    // Returns the job id (1, 2, ...), also stored in the Result.
+    uint64_t submit(const Graph& g, std::vector<std::pair<int, int>> flowPairs = {}, Completion done = nullptr,
+                    JobOptions options = {});
+    uint64_t submit(Graph&& g, std::vector<std::pair<int, int>> flowPairs = {}, Completion done = nullptr,
+                    JobOptions options = {}); // Moves g in
+    uint64_t submit(std::shared_ptr<const GraphSnapshot> g, std::vector<std::pair<int, int>> flowPairs = {},
+                    Completion done = nullptr, JobOptions options = {});
+    // Same, completing a future owned by the caller: jobs finish in any order and each waiter gets its own result.
+    // g is taken by value, a copy shares the caller's rows and an rvalue is moved in.
+    Ticket submitAsync(Graph g, std::vector<std::pair<int, int>> flowPairs = {}, JobOptions options = {});
+    Result get();                  // Wait for the next result of a job submitted without a callback
+    std::array<int, STAGES> workerCounts() const; // Workers of each stage of the started pipeline
+    // Under Overflow::Block, wait until submit would not; returns at once under the other policies. The server calls
+    // it before reading a request, so a saturated pipeline stops it reading from its sockets.
+    void waitForRoom();
+    size_t inFlightJobs() const; // Jobs admitted and not finished or dropped yet
 
 private:
    struct Job { 
-    Graph graph; // The graph to process
+    std::vector<int> order; // order[i] is the client id of vertex i, empty when the graph isn't relabeled
+    std::vector<int> position; // Inverse of order: vertex of each client id
+    std::shared_ptr<const GraphSnapshot> graph; // The graph to process, read-only and possibly shared with the caller
+    std::optional<SmallGraph<>> small; // Bitmask copy when the graph has at most 64 vertices, stages use it instead
     Result result; // Accumulated results from pipeline stages
-    // Build a Job by copying the graph
-    explicit Job(const Graph& g) : graph(g) {}
-    // explicit Job(Graph&& g) : graph(std::move(g)) {} // Move-construct if you prefer
+    Completion done; // Receives the result when set, otherwise the job goes to qout
+    uint64_t outSeq = 0; // Position among the jobs without a callback, get() returns them in this order
+    std::atomic<int> pending{STAGES}; // Stages still running on this job, the one that reaches 0 completes it
+    enum { Queued, Running, Dropped };
+    std::atomic<int> state{Queued}; // The first stage to start moves it to Running, only a Queued job can be dropped
+    StopToken stop; // Deadline of the job, child of JobOptions::cancel; the stages' algorithms poll it
+    std::atomic<StopToken::Reason> interrupted{StopToken::Reason::None}; // First reason a stage saw the token fired
+    // Build a Job on a snapshot, relabeled into a new one when a layout is requested
+    Job(std::shared_ptr<const GraphSnapshot> g, Graph::VertexOrder vo,
+        StopToken::Clock::time_point deadline = StopToken::Clock::time_point::max(),
+        std::shared_ptr<const StopToken> cancel = nullptr)
+        : order(layout(*g, vo)), position(order.size()),
+        graph(order.empty() ? std::move(g) : std::make_shared<const GraphSnapshot>(g->relabeled(order))),
+        stop(deadline, std::move(cancel)) {
+        for (size_t i = 0; i < order.size(); ++i) position[order[i]] = i;
+        if (SmallGraph<>::fits(*graph)) small.emplace(*graph);
+    }
+    static std::vector<int> layout(const Graph& g, Graph::VertexOrder vo) {
+        if (vo == Graph::VertexOrder::Original || SmallGraph<>::fits(g)) return {};
+        return g.vertexOrder(vo);
+    }
     };
 
-    // Shared handle to a Job (passed between stages)
+    // Shared handle to a Job (held by every stage it fans out to)
     using JobPtr = std::shared_ptr<Job>;  
 
-    // Thread queue
+    // Thread queue of the results for get()
     template<typename T>
     class QueueT {
         std::queue<T> q;
@@ -48,6 +176,13 @@ private:
             q.push(std::move(v)); // add item under lock  
             cv.notify_one(); // wake one waiting consumer
         }
+
+        // Move every item of vs in, one lock and one wake-up for all of them
+        void pushAll(std::vector<T>& vs){
+            std::unique_lock<std::mutex> lk(m);
+            for (T& v : vs) q.push(std::move(v));
+            cv.notify_all();
+        }
         
         T pop(){
             // lock for waiting
@@ -60,14 +195,58 @@ private:
         }
     };
 
-    //Queues connecting the 4 pipeline stages (and final output)
-    QueueT<JobPtr> q1, q2, q3, q4, qout;
+    Config config; // Layout, worker counts and queue capacity
+    std::atomic<uint64_t> lastId{0}; // Id of the latest submitted job
+    std::atomic<uint64_t> lastOutSeq{0}; // outSeq of the latest job submitted without a callback
+
+    // Input queue of each stage (every job is pushed to all four): lock-free rings, since every hop pays for them.
+    // The final output for get() keeps a locked queue, it has no bound so finishing a job never waits on get().
+    RingQueue<JobPtr> q1{ringSlots(config)}, q2{ringSlots(config)}, q3{ringSlots(config)}, q4{ringSlots(config)};
+    QueueT<JobPtr> qout;
+
+    // Jobs without a callback that finished ahead of an earlier one, held until qout can take them in order
+    std::mutex outMutex;
+    std::map<uint64_t, JobPtr> parked;
+    uint64_t delivered = 0; // outSeq of the last job pushed to qout
+
+    // config.workers[s] threads per stage, the stages read the job's graph side by side
+    std::vector<std::thread> threads;
+
+    // Worker moves (Config::adaptive). A move is a token pushed to the giving stage's queue, the worker that pops
+    // it switches to the destination recorded in 'moves', so no worker leaves a job half done.
+    JobPtr migrateToken = std::make_shared<Job>(std::make_shared<const GraphSnapshot>(0), Graph::VertexOrder::Original);
+    mutable std::mutex monitorMutex; // Protects assigned, moves and stopping
+    std::condition_variable monitorCv;
+    std::array<int, STAGES> assigned{}; // Workers of each stage, moves still in flight already counted
+    std::queue<int> moves[STAGES]; // Destination of every token queued on a stage
+    bool stopping = false;
+    std::atomic<int64_t> serviceNs[STAGES]{}; // Moving average of one job's time in each stage
+    std::atomic<int> serving[STAGES]{}; // Workers currently on each stage, kept by the workers for their batch size
+    std::thread monitorThread;
 
-    // One thread per pipeline stage
-    std::thread t1, t2, t3, t4;
+    // Admission: at most queueCapacity jobs in flight. A dropped job leaves the count at once but keeps its queue
+    // slots until the stages skip it or a submitter clears it out (enqueue), DropOldest rings get twice the room so
+    // that is rare.
+    mutable std::mutex admitMutex;
+    std::condition_variable admitCv;
+    size_t inFlight = 0;
+    std::deque<std::weak_ptr<Job>> admitted; // Submission order, for DropOldest
+    static size_t ringSlots(const Config& c) { return c.overflow == Overflow::DropOldest ? 2 * c.queueCapacity : c.queueCapacity; }
+    void admit(); // Take a slot following config.overflow
+    bool dropOldest(); // DropOldest: evict the oldest job no stage started, false if there is none
+    void enqueue(int stage, const JobPtr& job); // Push to a stage queue, under DropOldest without waiting for room
+    void release(); // Give a slot back
+    std::chrono::milliseconds retryAfter(); // Time for the stages to clear the current backlog
 
-    void stage1();  // Computes MST weight and forwards Job to q2
-    void stage2();  // Computes Cliques and forwards Job to q3
-    void stage3();  // Computes SCCs and forwards Job to q4
-    void stage4();  // Computes MaxFlow and pushes final Job to qout
+    RingQueue<JobPtr>& queue(int stage);
+    void worker(int stage); // Serves 'stage' until a sentinel, following any moves
+    static constexpr int64_t BATCH_NS = 100000; // A batch holds its jobs back from the other workers about this long
+    size_t batchSize(int stage); // Jobs to take per wake-up, see Config::maxBatch
+    void runStage(int stage, Job& j, Workspace& ws); // MST weight, cliques, SCCs or max flow of j
+    static bool interrupted(Job& j); // Whether j's token fired, noted in j.interrupted for its final status
+    void monitor(); // Rebalances the workers every rebalancePeriod until stop()
+    // Called by each stage when done with j. The last one completes it: to its callback, or returns true when j
+    // is to be handed to deliver()
+    bool finish(JobPtr& j);
+    void deliver(std::vector<JobPtr>& jobs); // Queue finished jobs for get() in submission order, empties jobs
 };
@@ -0,0 +1,167 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// Bounded lock-free MPMC queue (Vyukov's ring): every slot carries a sequence number telling producers and
+// consumers whose turn it is, so tryPush/tryPop are one CAS on the head or tail index plus a release store.
+// Head and tail sit on their own cache lines. The cells don't: a cell is a sequence number and a T (24 bytes
+// for the pipeline's shared_ptr jobs), so padding each to a line would make the rings nearly 3x larger, up to
+// 128 MB per stage at the largest queueCapacity. Neighbouring cells are contended only while a stage's queue
+// is almost empty, and popBatch then takes a run of them at once. The blocking push/pop spin for a short while
+// and only then park on a condition variable; the mutex is touched only when somebody is actually parked.
+template <typename T>
+class RingQueue {
+public:
+    explicit RingQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1; // Power of two, so the slot of position p is p & mask
+        mask = n - 1;
+        cells.reset(new Cell[n]);
+        for (size_t i = 0; i < n; ++i) cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+    size_t size() const { // Approximate while other threads push or pop
+        size_t tail = deq.load(std::memory_order_relaxed), head = enq.load(std::memory_order_relaxed);
+        return head > tail ? head - tail : 0;
+    }
+
+    // Leaves v untouched and returns false when the queue is full
+    bool tryPush(T& v) {
+        if (!pushSlot(v)) return false;
+        wake(notEmpty, popSleepers);
+        return true;
+    }
+
+    // Returns false when the queue is empty
+    bool tryPop(T& v) {
+        if (!popSlot(v)) return false;
+        wake(notFull, pushSleepers);
+        return true;
+    }
+
+    // Blocks while the queue is full
+    void push(T v) {
+        if (spin([&] { return tryPush(v); })) return;
+        park(notFull, pushSleepers, [&] { return pushSlot(v); });
+        wake(notEmpty, popSleepers);
+    }
+
+    // Blocks while the queue is empty
+    T pop() {
+        T v;
+        if (spin([&] { return tryPop(v); })) return v;
+        park(notEmpty, popSleepers, [&] { return popSlot(v); });
+        wake(notFull, pushSleepers);
+        return v;
+    }
+
+    // Blocks like pop() for the first item, then takes what is already there up to 'max' items in all, stopping
+    // after an item for which last(item) is true (a control item ends the batch). Producers waiting for room get
+    // one wake-up for the whole batch.
+    template <typename Last>
+    void popBatch(std::vector<T>& out, size_t max, Last&& last) {
+        out.clear();
+        T v;
+        if (!spin([&] { return popSlot(v); })) park(notEmpty, popSleepers, [&] { return popSlot(v); });
+        out.push_back(std::move(v));
+        while (out.size() < max && !last(out.back()) && popSlot(v)) out.push_back(std::move(v));
+        wake(notFull, pushSleepers, out.size() > 1);
+    }
+
+private:
+    static constexpr int SPINS = 128; // Tries before parking, a few microseconds
+
+    struct Cell { // Packed, not one per cache line (see above)
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enq{0}; // Next position to push
+    alignas(64) std::atomic<size_t> deq{0}; // Next position to pop
+    alignas(64) std::atomic<int> popSleepers{0}, pushSleepers{0};
+    std::mutex parkMutex;
+    std::condition_variable notEmpty, notFull;
+
+    bool pushSlot(T& v) {
+        size_t pos = enq.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            intptr_t diff = (intptr_t)cell->seq.load(std::memory_order_acquire) - (intptr_t)pos;
+            if (diff == 0) {
+                if (enq.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false; // The slot still holds the item of the previous lap
+            } else {
+                pos = enq.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(v);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool popSlot(T& v) {
+        size_t pos = deq.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            intptr_t diff = (intptr_t)cell->seq.load(std::memory_order_acquire) - (intptr_t)(pos + 1);
+            if (diff == 0) {
+                if (deq.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = deq.load(std::memory_order_relaxed);
+            }
+        }
+        v = std::move(cell->value);
+        cell->seq.store(pos + mask + 1, std::memory_order_release); // Free for the producer of the next lap
+        return true;
+    }
+
+    static void relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    template <typename Try>
+    static bool spin(Try&& attempt) {
+        for (int i = 0; i < SPINS; ++i) {
+            if (attempt()) return true;
+            relax();
+        }
+        return false;
+    }
+
+    // The sleeper count is raised before the last try and read by the other side after its push/pop, both
+    // behind seq_cst fences, so either the try succeeds or the other side sees the sleeper and notifies
+    template <typename Try>
+    void park(std::condition_variable& cv, std::atomic<int>& sleepers, Try&& attempt) {
+        std::unique_lock<std::mutex> lk(parkMutex);
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!attempt()) cv.wait(lk);
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void wake(std::condition_variable& cv, std::atomic<int>& sleepers, bool all = false) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) == 0) return;
+        std::lock_guard<std::mutex> lk(parkMutex); // Not between a sleeper's last try and its wait
+        if (all) cv.notify_all();
+        else cv.notify_one();
+    }
+};
@@ -1,23 +1,49 @@
 #include "pipling.hpp"
 #include "graph.hpp"
+#include "graph_file.hpp"
+#include "graph_import.hpp"
 #include <iostream>
 #include <sstream>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <unistd.h>
 #include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
 
-//Function for print all the results of 4 algorithms
+//Function for print the results of the requested algorithms (all 4 unless the request had a mask). Every answer
+//starts with a newline, which peer_closed may have sent ahead.
 std::string to_string(Pipling::Result res){
     std::ostringstream out;
-    out << "\nMST weight:\n" << res.mst_weight << std::endl;
-    out << "number of cliques:\n" << res.num_cliques << std::endl;
-    out << "Strongly Connected Components:\n";
-    auto sccs = res.sccs;
-    for (const auto& component : sccs) {
-        for (int v : component)
-            out << v << " ";
-        out << "\n";
+    if (res.status == Pipling::Status::Dropped) return "\nDropped: the server was overloaded, please resend.}";
+    auto requested = [&](Pipling::Stage s) { return (res.algorithms >> s) & 1; };
+    out << "\n";
+    if (res.status == Pipling::Status::TimedOut) out << "Timed out, partial results:\n";
+    if (res.status == Pipling::Status::Cancelled) out << "Cancelled, partial results:\n";
+    if (requested(Pipling::Mst)) out << "MST weight:\n" << res.mst_weight << std::endl;
+    if (requested(Pipling::Cliques)) out << "number of cliques:\n" << res.num_cliques << std::endl;
+    if (requested(Pipling::Scc)) {
+        out << "Strongly Connected Components:\n";
+        auto sccs = res.sccs;
+        for (const auto& component : sccs) {
+            for (int v : component)
+                out << v << " ";
+            out << "\n";
+        }
+    }
+    if (requested(Pipling::Flow)) out << "max flow:\n" << res.max_flow;
+    // Several requested pairs: list each one
+    if (requested(Pipling::Flow) && res.max_flows.size() > 1) {
+        for (size_t i = 0; i < res.max_flows.size(); ++i)
+            out << "\n" << res.flow_pairs[i].first << "->" << res.flow_pairs[i].second << ": " << res.max_flows[i];
     }
-    out << "max flow:\n" << res.max_flow;
 
     out << "}";
     return out.str();
@@ -35,12 +61,12 @@ static bool read_exact(int fd, void* buf, size_t n) {
     return true;
 }
 
-//Function for writting all n byts precisely
+//Function for writting all n byts precisely to a socket, a client that is gone fails it with EPIPE (no SIGPIPE)
 static bool write_all(int fd, const void* buf, size_t n) {
     const char* p = static_cast<const char*>(buf);
     size_t left = n;
     while (left) {
-        ssize_t w = ::write(fd, p, left);
+        ssize_t w = ::send(fd, p, left, MSG_NOSIGNAL);
         if (w < 0) { if (errno == EINTR) continue; return false; }
         p += w;
         left -= (size_t)w;
@@ -48,12 +74,127 @@ static bool write_all(int fd, const void* buf, size_t n) {
     return true;
 }
 
+//Whether the client is gone while it waits for its answer: a hang-up (POLLHUP), a socket error or a reset.
+//End of input alone is not enough, a client may shutdown(SHUT_WR) and still read. Over TCP that half-close looks
+//like a full close until something is written, so the first time it is seen the answer's leading newline is sent
+//ahead ('probed'): a client that really closed answers it with a reset, seen on a later call.
+static bool peer_closed(int fd, bool& probed) {
+    pollfd p{fd, POLLIN | POLLRDHUP, 0};
+    if (::poll(&p, 1, 0) <= 0) return false;
+    if (p.revents & (POLLHUP | POLLERR | POLLNVAL)) return true;
+    char c;
+    ssize_t r = ::recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    if (r < 0) return errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR; //ECONNRESET, EPIPE, ...
+    if (r == 0 && !probed) {
+        probed = true;
+        if (!write_all(fd, "\n", 1)) return true;
+    }
+    return false;
+}
+
+//Function for reading the (source, sink) list of an extended request: count, then count pairs
+static bool read_flow_pairs(int fd, std::vector<std::pair<int, int>>& pairs) {
+    int count;
+    if (!read_exact(fd, &count, sizeof(int))) return false;
+    if (count < 0) throw std::invalid_argument("error: Negative number of flow pairs");
+    pairs.clear();
+    for (int i = 0; i < count; ++i) {
+        int s, t;
+        if (!read_exact(fd, &s, sizeof(int))) return false;
+        if (!read_exact(fd, &t, sizeof(int))) return false;
+        pairs.push_back({s, t});
+    }
+    return true;
+}
+
+//Function for reading a graph file path: length, then the bytes
+static bool read_path(int fd, std::string& path) {
+    int len;
+    if (!read_exact(fd, &len, sizeof(int))) return false;
+    if (len <= 0 || len > 4096) throw std::invalid_argument("error: Invalid graph file path length");
+    path.assign(len, '\0');
+    return read_exact(fd, &path[0], len);
+}
+
+//Directory the graph files of choice 5 are read from: PIPLING_DATA_DIR, otherwise ./data
+static std::string data_dir() {
+    const char* dir = std::getenv("PIPLING_DATA_DIR");
+    return dir && *dir ? dir : "data";
+}
+
+//Function for resolving a client's graph file name inside the data directory: a relative path with no ".."
+//component that names a regular file (not a directory or device). Symbolic links anywhere on the path are
+//followed by realpath, and the file they lead to must still be inside the (resolved) data directory.
+static std::string data_file(const std::string& name) {
+    if (name.empty() || name[0] == '/' || name.find('\0') != std::string::npos) {
+        throw std::invalid_argument("error: Graph file must be a relative path");
+    }
+    for (size_t start = 0; start <= name.size();) {
+        size_t end = std::min(name.find('/', start), name.size());
+        if (name.compare(start, end - start, "..") == 0) throw std::invalid_argument("error: Graph file path can't contain ..");
+        start = end + 1;
+    }
+    char dir[PATH_MAX], file[PATH_MAX];
+    if (!::realpath(data_dir().c_str(), dir) || !::realpath((data_dir() + "/" + name).c_str(), file)) {
+        throw std::invalid_argument("error: No such graph file");
+    }
+    std::string root = dir, path = file;
+    if (root != "/") root += '/';
+    if (path.compare(0, root.size(), root) != 0) throw std::invalid_argument("error: Graph file must be inside the data directory");
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) throw std::invalid_argument("error: No such graph file");
+    return path;
+}
+
+//Function for loading a graph file from the data directory: binary CSR (.csr), DIMACS (.gr, .dimacs), METIS
+//(.metis, .graph) or a plain edge list (anything else). The pipeline runs on Graph, so a mapped .csr file is
+//copied into one (a single pass, see MappedGraph::toGraph) and unmapped before the job is queued.
+static Graph load_graph_file(const std::string& name) {
+    const std::string path = data_file(name);
+    auto endsWith = [&](const char* ext) {
+        size_t n = strlen(ext);
+        return path.size() >= n && path.compare(path.size() - n, n, ext) == 0;
+    };
+    if (endsWith(".csr")) return MappedGraph(path).toGraph();
+    if (endsWith(".gr") || endsWith(".dimacs")) return importGraphFile(path, GraphFormat::Dimacs, true);
+    if (endsWith(".metis") || endsWith(".graph")) return importGraphFile(path, GraphFormat::Metis);
+    return importGraphFile(path, GraphFormat::EdgeList, true);
+}
+
+//Layout and stage workers of the shared pipeline: the file named by PIPLING_CONFIG (see Pipling::Config::load),
+//otherwise the client's vertex ids with the spare cores on the clique stage, the costliest one. Relabeling is left
+//to the config file: requests run each algorithm once, and on random graphs the copy costs more than it saves.
+static Pipling::Config pipling_config() {
+    if (const char* path = std::getenv("PIPLING_CONFIG")) return Pipling::Config::load(path);
+    Pipling::Config config;
+    int cores = std::thread::hardware_concurrency();
+    config.workers[Pipling::Cliques] = std::max(1, cores - 3);
+    return config;
+}
+
+//The pipeline shared by every connection, started on first use and stopped at exit
+static Pipling& shared_pipling() {
+    static Pipling pipling(pipling_config());
+    static std::once_flag started;
+    std::call_once(started, [] { pipling.start(); });
+    return pipling;
+}
+
 //Callbeck function for lf, get the client massage and sand back answer
 bool my_handler(int new_socket) {
     int choice = 0;
+        //While the pipeline is full (block policy) leave the request in the socket, the client waits on TCP
+        shared_pipling().waitForRoom();
         if (!read_exact(new_socket, &choice, sizeof(int))) return false;
 
         Graph g(0, true);
+        std::vector<std::pair<int, int>> flowPairs; // Empty: default pair 0 -> n-1
+        // Choices 6, 7 and 8 are 3, 4 and 5 followed by an algorithm mask (bit 0 MST, 1 cliques, 2 SCCs, 3 max flow)
+        bool masked = (choice >= 6 && choice <= 8);
+        if (masked) choice -= 3;
+        // Choices 3 and 4 are 1 and 2 followed by a list of max flow pairs
+        bool extended = (choice == 3 || choice == 4);
+        if (extended) choice -= 2;
 
         if (choice == 1) { // GRAPH
             int vertices;
@@ -73,27 +214,51 @@ bool my_handler(int new_socket) {
             if (!read_exact(new_socket, &edges, sizeof(int)))   return false;
             if (!read_exact(new_socket, &seed, sizeof(int)))    return false;
             g = Graph::buildRandGraph(edges, vertices, seed);
+        } else if (choice == 5) { // GRAPH FILE in the server's data directory, always followed by the pairs
+            std::string path;
+            if (!read_path(new_socket, path)) return false;
+            g = load_graph_file(path);
+            extended = true;
         }else if(choice == 0){
             return false;
         }else{
             throw std::invalid_argument("error: Unknown command");
         }
-        //Create instance of Pipling
-        Pipling pipling;
-        //Create threds on start function
-        pipling.start();
-        pipling.submit(g);
-        Pipling::Result res = pipling.get();
-        pipling.stop();
+        if (extended && !read_flow_pairs(new_socket, flowPairs)) return false;
+        JobOptions options;
+        auto cancel = std::make_shared<StopToken>(); //Fired if the client leaves before its answer
+        options.cancel = cancel;
+        if (masked) {
+            int mask;
+            if (!read_exact(new_socket, &mask, sizeof(int))) return false;
+            if (mask <= 0 || mask > (int)Pipling::ALL_ALGORITHMS) throw std::invalid_argument("error: Invalid algorithm mask");
+            options.algorithms = mask;
+        }
+        //Feed the shared pipeline, the ticket's future receives this request's result only
+        Pipling::Ticket ticket;
+        try {
+            ticket = shared_pipling().submitAsync(std::move(g), flowPairs, options);
+        } catch (const Pipling::Saturated& busy) { //Reject policy: tell the client when to come back
+            std::string out = "\nServer busy, retry after " + std::to_string(busy.retryAfter.count()) + " ms}";
+            write_all(new_socket, out.c_str(), out.size());
+            return true;
+        }
+        //A client that hangs up meanwhile cancels its job, which then frees the stages within milliseconds
+        bool probed = false; //The answer's leading newline was already sent
+        while (ticket.result.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready) {
+            if (peer_closed(new_socket, probed)) cancel->cancel();
+        }
+        Pipling::Result res = ticket.result.get();
         std::string out = to_string(res);
-        std::cout << "Sending graph algorithms results..." << std::endl;
+        std::cout << "Sending graph algorithms results of job " << ticket.id << "..." << std::endl;
         //Send algorithms result to client 
-        write_all(new_socket, out.c_str(), out.size());
+        write_all(new_socket, out.c_str() + probed, out.size() - probed);
         return true;
         
 }
 
-int bind_listen(int port) {
+//Listening socket on port
+int listen_on(int port) {
     int fd = ::socket(AF_INET, SOCK_STREAM, 0);
     if (fd < 0) throw std::system_error(errno, std::generic_category(), "socket");
 
@@ -105,7 +270,6 @@ int bind_listen(int port) {
     a.sin_family      = AF_INET;
     a.sin_addr.s_addr = htonl(INADDR_ANY);
     a.sin_port        = htons((uint16_t)port);
-    size_t alen = sizeof(a);
     if (bind(fd, (sockaddr*)&a, sizeof(a)) < 0) {
         int e = errno; close(fd);
         throw std::system_error(e, std::generic_category(), "bind");
@@ -114,28 +278,65 @@ int bind_listen(int port) {
         int e = errno; ::close(fd);
         throw std::system_error(e, std::generic_category(), "listen");
     }
-     int new_socket = accept(fd, (struct sockaddr*)&a, (socklen_t*)&alen);
+    return fd;
+}
+
+//Listen on port and accept one client, returns the connected socket
+int bind_listen(int port) {
+    int fd = listen_on(port);
+    int new_socket = accept(fd, nullptr, nullptr);
+    close(fd);
     return new_socket;
 }
 
 #ifndef UNIT_TEST
+//Client threads alive at once; more connections wait in the listen backlog until one ends
+static const int MAX_CLIENTS = 64;
+static std::mutex clients_mutex;
+static std::condition_variable clients_changed;
+static int active_clients = 0;
+
+//Serve one client until it sends 0 or disconnects, then close its socket and free its slot
+static void serve_client(int fd) {
+    try {
+        while (my_handler(fd)) {}
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+    shutdown(fd, SHUT_WR);
+    close(fd);
+    std::lock_guard<std::mutex> lock(clients_mutex);
+    --active_clients;
+    clients_changed.notify_all();
+}
+
 int main() {
     const int PORT = 8080;
     
-    //Creates an instance of lf server
-    std::cout << "Server listening on port " << PORT << "...\n"
-              << "Press ENTER to stop.\n";
-    int fd = bind_listen(PORT);
-    //get request from client and send back respond
+    std::cout << "Server listening on port " << PORT << "...\n";
+    int fd = listen_on(PORT);
+    //Every client gets its own thread, their requests overlap in the shared pipeline
     while(true){
-        if(!my_handler(fd)){
+        {
+            std::unique_lock<std::mutex> lock(clients_mutex);
+            clients_changed.wait(lock, [] { return active_clients < MAX_CLIENTS; });
+        }
+        int client = accept(fd, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
             break;
         }
+        {
+            std::lock_guard<std::mutex> lock(clients_mutex);
+            ++active_clients;
+        }
+        std::thread(serve_client, client).detach();
     }
-    std::cout << "Stopped.\n";
-    //Close connection
-    shutdown(fd, SHUT_WR);
     close(fd);
+    //The shared pipeline is stopped by its static destructor after main returns: no client may still be submitting
+    std::unique_lock<std::mutex> lock(clients_mutex);
+    clients_changed.wait(lock, [] { return active_clients == 0; });
+    std::cout << "Stopped.\n";
     return 0;
 }
 #endif
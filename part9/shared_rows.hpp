@@ -0,0 +1,92 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Copy-on-write storage behind Graph. Copies share every row; the first write to a shared row
+// clones that row only, so snapshotting a graph costs a pointer per row and a caller that keeps
+// editing its Graph pays for the rows it touches. A row whose count is 1 belongs to this copy
+// alone; the acquire fence orders our writes after the last reader of another copy let go of it.
+template <typename T>
+class SharedRows {
+public:
+    using Row = std::vector<T>;
+
+    SharedRows() = default;
+    explicit SharedRows(size_t n) { assign(n); }
+
+    size_t size() const { return rows.size(); }
+    const Row& operator[](size_t i) const { return *rows[i]; }
+
+    // Row i for writing, cloned first if another copy shares it
+    Row& mut(size_t i) {
+        std::shared_ptr<Row>& r = rows[i];
+        if (r.use_count() != 1) r = std::make_shared<Row>(*r);
+        else std::atomic_thread_fence(std::memory_order_acquire);
+        return *r;
+    }
+
+    // n empty rows, sharing one empty vector until they are written
+    void assign(size_t n) {
+        auto none = std::make_shared<Row>();
+        rows.assign(n, none);
+    }
+    // Grow to n rows, the new ones empty (existing rows stay shared)
+    void extend(size_t n) {
+        while (rows.size() < n) rows.push_back(std::make_shared<Row>());
+    }
+
+private:
+    std::vector<std::shared_ptr<Row>> rows;
+};
+
+// Flat array stored as SharedRows blocks of BLOCK elements, so copies share everything but the
+// blocks written afterwards (Graph's edge table: appends and swaps touch one or two blocks)
+template <typename T>
+class SharedArray {
+public:
+    static constexpr size_t BLOCK = 1024;
+
+    class const_iterator {
+    public:
+        const_iterator(const SharedArray* a, size_t i) : a(a), i(i) {}
+        const T& operator*() const { return (*a)[i]; }
+        const_iterator& operator++() { ++i; return *this; }
+        bool operator!=(const const_iterator& o) const { return i != o.i; }
+
+    private:
+        const SharedArray* a;
+        size_t i;
+    };
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](size_t i) const { return blocks[i / BLOCK][i % BLOCK]; }
+    void set(size_t i, const T& value) { blocks.mut(i / BLOCK)[i % BLOCK] = value; }
+
+    void push_back(const T& value) {
+        if (count % BLOCK == 0) blocks.extend(count / BLOCK + 1);
+        Row& block = blocks.mut(count / BLOCK);
+        if (block.capacity() == 0) block.reserve(BLOCK);
+        block.push_back(value);
+        ++count;
+    }
+    void pop_back() {
+        --count;
+        blocks.mut(count / BLOCK).pop_back();
+    }
+    void clear() {
+        blocks = SharedRows<T>();
+        count = 0;
+    }
+
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, count}; }
+
+private:
+    using Row = typename SharedRows<T>::Row;
+
+    SharedRows<T> blocks;
+    size_t count = 0;
+};
@@ -0,0 +1,214 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "stop_token.hpp"
+
+// Fast path for graphs of at most N (<= 64) vertices: row u of the adjacency is one machine word
+// with bit v set for the edge u->v. Every algorithm works on a few fixed-size arrays on the stack,
+// so apart from the returned vectors nothing is allocated. Results match the Graph versions, except that
+// findSCCs lists the components (and the vertices in each) in another order: the sets are the same.
+template <int N = 64>
+class SmallGraph {
+    static_assert(N > 0 && N <= 64, "SmallGraph rows are single 64-bit words");
+
+public:
+    using Mask = uint64_t;
+
+    // Whether g fits in a SmallGraph<N>
+    static bool fits(const Graph& g) { return g.getNumVertices() <= N; }
+
+    explicit SmallGraph(const Graph& g) : n(g.getNumVertices()), directed(g.isDirected()) {
+        if (!fits(g)) throw std::invalid_argument("Error: Graph too large for SmallGraph.\n");
+        adj.fill(0);
+        for (int u = 0; u < n; ++u)
+            for (int v : g.getNeighbors(u)) adj[u] |= bit(v);
+    }
+
+    int getNumVertices() const { return n; }
+
+    // Spanning forest weight (unit weights): one edge per vertex beyond the first of each component
+    int64_t mstWeight() const {
+        if (directed) return -1; // MST is for undirected graphs only
+        int64_t weight = 0;
+        Mask left = all();
+        while (left) {
+            Mask comp = reach(lowest(left), adj);
+            weight += __builtin_popcountll(comp) - 1;
+            left &= ~comp;
+        }
+        return weight;
+    }
+
+    // Same definition as Graph::countCliques: a set is a clique when v is a neighbor of u for all u < v in it.
+    // The only unbounded one here (a dense graph of 64 vertices has up to 2^64 cliques), so it takes a StopToken too.
+    uint64_t countCliques(const StopToken* stop = nullptr) const {
+        std::array<Mask, N> higher; // Neighbors above u
+        for (int u = 0; u < n; ++u) higher[u] = adj[u] & above(u);
+        StopPoll stopped(stop);
+        return extendCliques(all(), higher, stopped);
+    }
+
+    // SCCs from the reachability closure: u and v share a component when each reaches the other.
+    // Components come by lowest vertex, each in increasing order (Graph::findSCCs uses Kosaraju's order).
+    std::vector<std::vector<int>> findSCCs() const {
+        std::array<Mask, N> closure = adj;
+        for (int u = 0; u < n; ++u) closure[u] |= bit(u);
+        for (int k = 0; k < n; ++k) // Warshall, one word per row
+            for (int u = 0; u < n; ++u)
+                if (closure[u] & bit(k)) closure[u] |= closure[k];
+
+        std::vector<std::vector<int>> components;
+        Mask left = all();
+        while (left) {
+            int v = lowest(left);
+            Mask comp = 0;
+            for (Mask m = closure[v]; m; m &= m - 1) {
+                int u = lowest(m);
+                if (closure[u] & bit(v)) comp |= bit(u);
+            }
+            std::vector<int> component;
+            for (Mask m = comp; m; m &= m - 1) component.push_back(lowest(m));
+            components.push_back(std::move(component));
+            left &= ~comp;
+        }
+        return components;
+    }
+
+    bool hasEulerCircuit() const {
+        Mask used = 0; // Vertices with edges
+        Mask undirectedAdj[N];
+        for (int u = 0; u < n; ++u) undirectedAdj[u] = adj[u];
+        for (int u = 0; u < n; ++u) {
+            for (Mask m = adj[u]; m; m &= m - 1) undirectedAdj[lowest(m)] |= bit(u);
+            if (adj[u]) used |= bit(u);
+        }
+        for (int u = 0; u < n; ++u) {
+            if (undirectedAdj[u]) used |= bit(u);
+            int out = __builtin_popcountll(adj[u]);
+            if (directed ? out != inDegree(u) : out % 2 != 0) return false;
+        }
+        if (!used) return false; // No edges in the graph
+        std::array<Mask, N> rows;
+        for (int u = 0; u < n; ++u) rows[u] = undirectedAdj[u];
+        return (reach(lowest(used), rows) & used) == used;
+    }
+
+    // Hierholzer on a copy of the rows (one word per vertex), same contract as Graph::findEulerCircuit
+    std::vector<int> findEulerCircuit(int start = 0) const {
+        std::vector<int> circuit;
+        if (!hasEulerCircuit() || start < 0 || start >= n || !adj[start]) return circuit;
+        std::array<Mask, N> left = adj;
+        int path[N * N + 1]; // Trail stack, at most one entry per edge plus the start
+        int top = 0;
+        path[top++] = start;
+        while (top > 0) {
+            int v = path[top - 1];
+            if (left[v]) {
+                int u = lowest(left[v]);
+                left[v] &= ~bit(u);
+                if (!directed) left[u] &= ~bit(v);
+                path[top++] = u;
+            } else {
+                circuit.push_back(v);
+                --top;
+            }
+        }
+        std::reverse(circuit.begin(), circuit.end());
+        return circuit;
+    }
+
+    // Edmonds-Karp with residual capacities in a byte matrix and one word per row marking the positive ones
+    int64_t maxFlow(int source, int sink) const {
+        if (source < 0 || source >= n || sink < 0 || sink >= n) {
+            throw std::invalid_argument("Error: Invalid vertex index.\n");
+        }
+        if (source == sink) return 0;
+        uint8_t cap[N][N] = {}; // An undirected edge gives capacity 1 both ways, residuals stay <= 2
+        Mask positive[N];
+        for (int u = 0; u < n; ++u) {
+            positive[u] = adj[u];
+            for (Mask m = adj[u]; m; m &= m - 1) cap[u][lowest(m)] = 1;
+        }
+
+        int64_t flow = 0;
+        int parent[N];
+        for (;;) {
+            // BFS one frontier word at a time
+            Mask seen = bit(source), frontier = bit(source);
+            while (frontier && !(seen & bit(sink))) {
+                Mask next = 0;
+                for (Mask f = frontier; f; f &= f - 1) {
+                    int u = lowest(f);
+                    Mask fresh = positive[u] & ~seen & ~next;
+                    for (Mask m = fresh; m; m &= m - 1) parent[lowest(m)] = u;
+                    next |= fresh;
+                }
+                seen |= next;
+                frontier = next;
+            }
+            if (!(seen & bit(sink))) break;
+            for (int v = sink; v != source; v = parent[v]) { // Unit bottleneck: every residual is >= 1
+                int u = parent[v];
+                if (--cap[u][v] == 0) positive[u] &= ~bit(v);
+                ++cap[v][u];
+                positive[v] |= bit(u);
+            }
+            ++flow;
+        }
+        return flow;
+    }
+
+    std::vector<int64_t> maxFlows(const std::vector<std::pair<int, int>>& pairs) const {
+        std::vector<int64_t> flows;
+        flows.reserve(pairs.size());
+        for (const auto& [s, t] : pairs) flows.push_back(maxFlow(s, t));
+        return flows;
+    }
+
+private:
+    int n;
+    bool directed;
+    std::array<Mask, N> adj;
+
+    static Mask bit(int v) { return Mask(1) << v; }
+    static int lowest(Mask m) { return __builtin_ctzll(m); }
+    static Mask above(int u) { return u >= 63 ? 0 : ~((Mask(2) << u) - 1); } // Bits u+1..63
+    Mask all() const { return n == 64 ? ~Mask(0) : bit(n) - 1; }
+
+    int inDegree(int v) const {
+        int d = 0;
+        for (int u = 0; u < n; ++u) d += (adj[u] >> v) & 1;
+        return d;
+    }
+
+    // Vertices reachable from v over 'rows'
+    Mask reach(int v, const std::array<Mask, N>& rows) const {
+        Mask seen = bit(v), frontier = bit(v);
+        while (frontier) {
+            Mask next = 0;
+            for (Mask f = frontier; f; f &= f - 1) next |= rows[lowest(f)];
+            frontier = next & ~seen;
+            seen |= next;
+        }
+        return seen;
+    }
+
+    // Cliques made of the current one plus vertices of 'cand' (all above the last vertex added).
+    // At most 2^64 - 1 for 64 vertices, so the sum fits; it is checked like Graph's accumulators all the same.
+    static uint64_t extendCliques(Mask cand, const std::array<Mask, N>& higher, StopPoll& stopped) {
+        uint64_t count = 0;
+        for (; cand && !stopped(); cand &= cand - 1) {
+            int v = lowest(cand);
+            uint64_t withV = extendCliques(cand & higher[v], higher, stopped);
+            if (__builtin_add_overflow(count, withV, &count) || __builtin_add_overflow(count, uint64_t(1), &count)) {
+                throw std::overflow_error("Error: Result does not fit the accumulator type.\n");
+            }
+        }
+        return count;
+    }
+};
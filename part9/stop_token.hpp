@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+
+// Cooperative cancellation for the long graph algorithms: once cancel() is called or the deadline passes they
+// return early with what they computed so far. A token also stops when its parent does, so one token per client
+// connection can cancel every job of that client while each job keeps its own deadline.
+class StopToken {
+public:
+    using Clock = std::chrono::steady_clock;
+    enum class Reason { None, Cancelled, Expired };
+
+    StopToken() = default;
+    explicit StopToken(Clock::time_point deadline, std::shared_ptr<const StopToken> parent = nullptr)
+        : deadline(deadline), parent(std::move(parent)) {}
+    StopToken(const StopToken&) = delete;
+    StopToken& operator=(const StopToken&) = delete;
+
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+    // Why the holder should stop, None while it may go on. Reads the clock only when there is a deadline.
+    Reason reason() const {
+        if (cancelled.load(std::memory_order_relaxed)) return Reason::Cancelled;
+        if (parent) {
+            Reason r = parent->reason();
+            if (r != Reason::None) return r;
+        }
+        if (deadline != Clock::time_point::max() && Clock::now() >= deadline) return Reason::Expired;
+        return Reason::None;
+    }
+    bool stopRequested() const { return reason() != Reason::None; }
+
+private:
+    std::atomic<bool> cancelled{false};
+    Clock::time_point deadline = Clock::time_point::max(); // max: none
+    std::shared_ptr<const StopToken> parent;
+};
+
+// Polls a StopToken (nullptr: never stops) from an algorithm's inner loop. The token is read on the first call and
+// then every 'stride' calls, so a loop step of a few nanoseconds doesn't pay for a clock read; once stopped it stays stopped.
+// One per thread, the token itself may be shared.
+class StopPoll {
+public:
+    explicit StopPoll(const StopToken* token, unsigned stride = 1024) : token(token), stride(stride) {}
+
+    bool operator()() {
+        if (!token || stopped) return stopped;
+        if (calls-- == 0) {
+            calls = stride - 1;
+            stopped = token->stopRequested();
+        }
+        return stopped;
+    }
+
+private:
+    const StopToken* token;
+    unsigned stride;
+    unsigned calls = 0;
+    bool stopped = false;
+};
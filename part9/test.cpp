@@ -1,7 +1,22 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest.h"
 #include "graph.hpp"
+#include "workspace.hpp"
+#include "smallgraph.hpp"
+#include "compressed_graph.hpp"
+#include "graph_file.hpp"
+#include "graph_import.hpp"
+#include "stop_token.hpp"
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <system_error>
 #include <vector>
+#include <chrono>
+#include <memory>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
 static std::set<std::pair<int,int>> edge_set_undirected(const Graph& g) {
     std::set<std::pair<int,int>> es;
@@ -284,3 +299,654 @@ TEST_CASE("buildRandGraph: structure & determinism (same seed gives same graph)"
         CHECK(u != v); 
     }
 }
+
+TEST_CASE("maxFlows: several pairs on one residual network") {
+    Graph g(4, true);
+    g.addEdge(0,1);
+    g.addEdge(0,2);
+    g.addEdge(1,2);
+    g.addEdge(1,3);
+    g.addEdge(2,3);
+    std::vector<std::pair<int,int>> pairs = {{0,3}, {1,3}, {2,3}, {3,0}, {1,1}};
+    CHECK(g.maxFlows(pairs) == std::vector<int64_t>({2, 2, 1, 0, 0}));
+    CHECK(g.maxFlows<int>(pairs, 1) == std::vector<int>({2, 2, 1, 0, 0}));
+    CHECK(g.maxFlows(pairs, 1) == g.maxFlows(pairs, 4));
+    CHECK(g.maxFlows({}).empty());
+    CHECK_THROWS_AS(g.maxFlows({{0,4}}), std::invalid_argument);
+}
+
+TEST_CASE("maxFlow: min cut from the final residual graph") {
+    Graph g(4, true);
+    g.addEdge(0,1);
+    g.addEdge(0,2);
+    g.addEdge(1,3);
+    g.addEdge(2,1);
+    MinCut cut;
+    CHECK(g.maxFlow(0,3,&cut) == 1);
+    CHECK(cut.value == 1);
+    std::sort(cut.sourceSide.begin(), cut.sourceSide.end());
+    CHECK(cut.sourceSide == std::vector<int>({0,1,2}));
+    REQUIRE(cut.cutEdges.size() == 1);
+    CHECK(cut.cutEdges[0] == std::make_pair(1,3));
+}
+
+TEST_CASE("gomoryHuTree: every pair matches a direct max flow") {
+    Graph g = Graph::buildRandGraph(14, 8, 5);
+    GomoryHuTree serial = g.gomoryHuTree(1);
+    GomoryHuTree parallel = g.gomoryHuTree(3);
+    for (int u = 0; u < 8; ++u) {
+        for (int v = 0; v < 8; ++v) {
+            int expected = (u == v) ? 0 : g.maxFlow(u, v);
+            CHECK(serial.minCut(u, v) == expected);
+            CHECK(parallel.minCut(u, v) == expected);
+        }
+    }
+    Graph d(3, true);
+    CHECK_THROWS_AS(d.gomoryHuTree(), std::invalid_argument);
+}
+
+TEST_CASE("countCliques / mstWeight: wide accumulators beyond 31 vertices") {
+    Graph path(40, false);
+    for (int v = 0; v + 1 < 40; ++v) path.addEdge(v, v + 1);
+    CHECK(path.countCliques() == 79u);
+    CHECK(path.countCliques<uint32_t>() == 79u);
+    CHECK(path.mstWeight() == 39);
+
+    Graph forest(4, false);
+    forest.addEdge(0,1);
+    forest.addEdge(2,3);
+    CHECK(forest.mstWeight<int>() == 2);
+}
+
+TEST_CASE("countCliques: a count that doesn't fit the accumulator throws instead of wrapping") {
+    const int n = 17; // 2^17 - 1 cliques, more than 16 bits hold
+    Graph complete(n, false);
+    for (int u = 0; u < n; ++u)
+        for (int v = u + 1; v < n; ++v) complete.addEdge(u, v);
+    CHECK_THROWS_AS(complete.countCliques<uint16_t>(), std::overflow_error);
+    CHECK(complete.countCliques<uint32_t>() == (1u << n) - 1);
+
+    Graph fits(16, false); // 2^16 - 1 cliques, exactly the largest 16 bit value
+    for (int u = 0; u < 16; ++u)
+        for (int v = u + 1; v < 16; ++v) fits.addEdge(u, v);
+    CHECK(fits.countCliques<uint16_t>() == 0xFFFF);
+}
+
+// Check that 'circuit' is closed and walks every edge of g exactly once
+static bool is_euler_circuit(const Graph& g, const std::vector<int>& circuit, bool directed) {
+    if (circuit.size() != static_cast<size_t>(g.getNumEdges()) + 1 || circuit.front() != circuit.back()) return false;
+    std::multiset<std::pair<int,int>> left;
+    for (int u = 0; u < g.getNumVertices(); ++u)
+        for (int v : g.getNeighbors(u))
+            if (directed || u < v) left.insert({u, v});
+    for (size_t i = 0; i + 1 < circuit.size(); ++i) {
+        int u = circuit[i], v = circuit[i + 1];
+        if (!directed && u > v) std::swap(u, v);
+        auto it = left.find({u, v});
+        if (it == left.end()) return false;
+        left.erase(it);
+    }
+    return left.empty();
+}
+
+TEST_CASE("findEulerCircuit: edge ids survive removeEdge and every edge is walked once") {
+    // Two triangles sharing vertex 0 plus a square 0-3-5-6, as an undirected graph
+    Graph g(7, false);
+    g.addEdge(1,4); // Makes 1 and 4 odd, removed below so its id gets reused
+    g.addEdge(0,1); g.addEdge(1,2); g.addEdge(2,0);
+    g.addEdge(0,3); g.addEdge(3,4); g.addEdge(4,0);
+    g.addEdge(3,5); g.addEdge(5,6); g.addEdge(6,3);
+    CHECK(g.getNumEdges() == 10);
+    CHECK(g.findEulerCircuit().empty());
+    g.removeEdge(1,4);
+    g.removeEdge(1,4); // Removing a missing edge changes nothing
+    CHECK(g.getNumEdges() == 9);
+    auto circuit = g.findEulerCircuit(3);
+    CHECK(circuit.front() == 3);
+    CHECK(is_euler_circuit(g, circuit, false));
+
+    Graph d(4, true);
+    d.addEdge(0,1); d.addEdge(1,2); d.addEdge(2,0);
+    d.addEdge(2,3); d.addEdge(3,2);
+    CHECK(is_euler_circuit(d, d.findEulerCircuit(2), true));
+}
+
+TEST_CASE("hasEulerPath / findEulerPath: open trails between the odd vertices") {
+    Graph g(5, false);
+    g.addEdge(0,1); g.addEdge(1,2); g.addEdge(2,0); g.addEdge(2,3);
+    CHECK_FALSE(g.hasEulerCircuit());
+    CHECK(g.hasEulerPath());
+    auto path = g.findEulerPath();
+    REQUIRE(path.size() == 5);
+    CHECK(((path.front() == 2 && path.back() == 3) || (path.front() == 3 && path.back() == 2)));
+    g.addEdge(3,4);
+    g.addEdge(4,2); // All degrees even again
+    CHECK(g.hasEulerCircuit());
+    CHECK(g.findEulerPath().size() == 7);
+    g.removeEdge(2,3); // 2-4-3 keeps it connected, now 2 and 3 are odd
+    CHECK(g.hasEulerPath());
+    g.removeEdge(3,4); // 3 becomes isolated, the rest is still one component with 2 and 4 odd
+    CHECK(g.hasEulerPath());
+    CHECK_FALSE(g.hasEulerCircuit());
+    g.addEdge(3,4);
+    g.removeEdge(0,1);
+    g.removeEdge(1,2);
+    g.removeEdge(2,0);
+    CHECK(g.hasEulerPath()); // 2-4-3
+    g.addEdge(0,1); // Second component
+    CHECK_FALSE(g.hasEulerPath());
+
+    Graph d(4, true);
+    d.addEdge(0,1); d.addEdge(1,2); d.addEdge(2,0); d.addEdge(0,3);
+    CHECK_FALSE(d.hasEulerCircuit());
+    CHECK(d.hasEulerPath());
+    auto dpath = d.findEulerPath();
+    CHECK(dpath.front() == 0);
+    CHECK(dpath.back() == 3);
+    d.addEdge(2,3); // 0 and 2 both out-heavy
+    CHECK_FALSE(d.hasEulerPath());
+}
+
+TEST_CASE("findEulerCircuitParallel: valid circuits on larger Eulerian graphs") {
+    // Union of edge-disjoint cycles v -> v+step (mod n) is Eulerian
+    const int n = 997;
+    Graph g(n, false), d(n, true);
+    for (int step : {1, 2, 5, 17}) {
+        for (int v = 0; v < n; ++v) {
+            g.addEdge(v, (v + step) % n);
+            d.addEdge(v, (v + step) % n);
+        }
+    }
+    REQUIRE(g.hasEulerCircuit());
+    REQUIRE(d.hasEulerCircuit());
+    for (int threads : {1, 4}) {
+        auto c = g.findEulerCircuitParallel(3, threads, true);
+        CHECK(c.front() == 3);
+        CHECK(g.isEulerCircuit(c));
+        CHECK(d.isEulerCircuit(d.findEulerCircuitParallel(0, threads, true)));
+    }
+    CHECK(g.isEulerCircuit(g.findEulerCircuit()));
+    CHECK_FALSE(g.isEulerCircuit({0, 1, 0}));
+
+    Graph odd(3, false);
+    odd.addEdge(0,1);
+    CHECK(odd.findEulerCircuitParallel().empty());
+}
+
+TEST_CASE("findSCCs / hasEulerCircuit: 200k-vertex path doesn't overflow the stack") {
+    const int n = 200000;
+    Graph path(n, true);
+    for (int v = 0; v + 1 < n; ++v) path.addEdge(v, v + 1);
+    CHECK(path.findSCCs().size() == static_cast<size_t>(n));
+    path.addEdge(n - 1, 0); // Now one big cycle
+    auto comps = path.findSCCs();
+    REQUIRE(comps.size() == 1);
+    CHECK(comps[0].size() == static_cast<size_t>(n));
+    path.removeEdge(n - 1, 0); // Stale components: checked on the scratch union-find
+    CHECK_FALSE(path.hasEulerCircuit());
+    CHECK(path.hasEulerPath());
+}
+
+TEST_CASE("Workspace: one workspace reused across algorithms and graphs") {
+    Workspace ws;
+    Graph g(4, true);
+    g.addEdge(0,1);
+    g.addEdge(1,3);
+    g.addEdge(0,2);
+    g.addEdge(2,3);
+    g.addEdge(3,0);
+    for (int round = 0; round < 3; ++round) {
+        CHECK(g.maxFlow(0, 3, nullptr, &ws) == 2);
+        CHECK(g.maxFlows({{0,3}, {3,1}}, 1, &ws) == std::vector<int64_t>({2, 1}));
+        CHECK(g.findSCCs(&ws).size() == 1);
+        CHECK_FALSE(g.hasEulerCircuit(&ws));
+    }
+    Graph u(5, false);
+    u.addEdge(0,1); u.addEdge(1,2); u.addEdge(3,4);
+    CHECK(u.mstWeight(&ws) == 3);
+    MinCut cut;
+    CHECK(u.maxFlow(0, 2, &cut, &ws) == 1);
+    CHECK(cut.sourceSide == std::vector<int>({0}));
+    REQUIRE(cut.cutEdges.size() == 1);
+    CHECK(cut.cutEdges[0] == std::make_pair(0,1));
+}
+
+// Bytes requested from operator new by every thread of the test binary, to check that reused workspaces don't allocate
+static std::atomic<size_t> allocatedBytes{0};
+void* operator new(size_t n) {
+    allocatedBytes.fetch_add(n, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+TEST_CASE("Workspace: repeated flow queries, threaded or not, reuse its buffers") {
+    const int n = 20000; // Residual network of about 1 MB
+    Graph g(n, false);
+    for (int v = 0; v < n; ++v) {
+        g.addEdge(v, (v + 1) % n);
+        g.addEdge(v, (v + 7) % n);
+    }
+    const std::vector<std::pair<int, int>> pairs = {{0, n / 2}, {1, n / 3}, {2, n - 1}, {3, 5}};
+    for (int threads : {1, 3}) {
+        Workspace ws;
+        std::vector<int64_t> first = g.maxFlows(pairs, threads, &ws);
+        CHECK(first == std::vector<int64_t>({4, 4, 4, 4}));
+        for (int round = 0; round < 3; ++round) {
+            size_t before = allocatedBytes.load();
+            std::vector<int64_t> again = g.maxFlows(pairs, threads, &ws);
+            size_t used = allocatedBytes.load() - before; // Before any CHECK, doctest allocates too
+            CHECK(again == first);
+            // The result and, with helpers, the thread handles: nothing that grows with the graph
+            CHECK(used < 4096);
+        }
+    }
+}
+
+static std::vector<std::vector<int>> sorted_sccs(std::vector<std::vector<int>> comps) {
+    for (auto& c : comps) std::sort(c.begin(), c.end());
+    std::sort(comps.begin(), comps.end());
+    return comps;
+}
+
+TEST_CASE("SmallGraph: same results as Graph on random graphs up to 64 vertices") {
+    for (int seed = 1; seed <= 20; ++seed) {
+        int n = 2 + seed * 3 % 63; // 2..64
+        Graph u = Graph::buildRandGraph(std::min(n * (n - 1) / 2, n + seed % 7), n, seed);
+        Graph d(n, true);
+        srand(seed);
+        for (int i = 0; i < 2 * n; ++i) {
+            int a = rand() % n, b = rand() % n;
+            if (a != b) d.addEdge(a, b);
+        }
+        if (n <= 20) d.addEdge(0, n - 1);
+        for (const Graph* g : {&u, &d}) {
+            SmallGraph<> small(*g);
+            CHECK(small.mstWeight() == g->mstWeight());
+            CHECK(sorted_sccs(small.findSCCs()) == sorted_sccs(g->findSCCs()));
+            CHECK(small.hasEulerCircuit() == g->hasEulerCircuit());
+            CHECK(small.maxFlows({{0, n - 1}, {n - 1, 0}, {1, n / 2}}) ==
+                  g->maxFlows({{0, n - 1}, {n - 1, 0}, {1, n / 2}}));
+            if (n <= 24) CHECK(small.countCliques() == g->countCliques());
+        }
+    }
+}
+
+TEST_CASE("SmallGraph: Euler circuits, edge cases and the 64-vertex limit") {
+    Graph c(64, false); // One cycle through every vertex, bit 63 included
+    for (int v = 0; v < 64; ++v) c.addEdge(v, (v + 1) % 64);
+    SmallGraph<> small(c);
+    CHECK(small.hasEulerCircuit());
+    auto circuit = small.findEulerCircuit(63);
+    CHECK(circuit.front() == 63);
+    CHECK(c.isEulerCircuit(circuit));
+    CHECK(small.mstWeight() == 63);
+    CHECK(small.countCliques() == 64 + 64);
+    CHECK(small.maxFlow(0, 32) == 2);
+
+    Graph d(5, true); // Two directed cycles sharing vertex 0
+    d.addEdge(0,1); d.addEdge(1,2); d.addEdge(2,0);
+    d.addEdge(0,3); d.addEdge(3,0);
+    SmallGraph<8> sd(d);
+    CHECK(sd.hasEulerCircuit());
+    CHECK(d.isEulerCircuit(sd.findEulerCircuit()));
+    CHECK(sd.findEulerCircuit(4).empty()); // Isolated start
+    CHECK(sd.mstWeight() == -1);
+    CHECK(sorted_sccs(sd.findSCCs()) == std::vector<std::vector<int>>({{0,1,2,3}, {4}}));
+
+    Graph empty(3, false);
+    CHECK_FALSE(SmallGraph<>(empty).hasEulerCircuit());
+    CHECK_THROWS_AS(SmallGraph<>(empty).maxFlow(0, 3), std::invalid_argument);
+    CHECK_FALSE(SmallGraph<>::fits(Graph(65, false)));
+    CHECK_THROWS_AS(SmallGraph<>(Graph(65, false)), std::invalid_argument);
+}
+
+TEST_CASE("vertexOrder / relabeled: every layout is a permutation and keeps the results") {
+    Graph path(6, false); // 0-1-2-3-4-5 with scrambled ids
+    int ids[] = {3, 0, 5, 1, 4, 2};
+    for (int i = 0; i + 1 < 6; ++i) path.addEdge(ids[i], ids[i + 1]);
+    auto rcm = path.vertexOrder(Graph::VertexOrder::ReverseCuthillMcKee);
+    Graph banded = path.relabeled(rcm);
+    for (int v = 0; v < 6; ++v) // Path becomes 0-1-..-5: bandwidth 1
+        for (int w : banded.getNeighbors(v)) CHECK(std::abs(w - v) == 1);
+    CHECK(path.vertexOrder(Graph::VertexOrder::Bfs).front() == 0);
+    CHECK_THROWS_AS(path.relabeled({0, 1, 2}), std::invalid_argument);
+    CHECK_THROWS_AS(path.relabeled({0, 0, 1, 2, 3, 4}), std::invalid_argument);
+
+    Graph d(120, true);
+    srand(7);
+    for (int i = 0; i < 400; ++i) {
+        int a = rand() % 120, b = rand() % 120;
+        if (a != b) d.addEdge(a, b);
+    }
+    for (auto kind : {Graph::VertexOrder::Original, Graph::VertexOrder::DegreeDescending,
+                      Graph::VertexOrder::ReverseCuthillMcKee, Graph::VertexOrder::Bfs}) {
+        auto order = d.vertexOrder(kind);
+        auto sorted = order;
+        std::sort(sorted.begin(), sorted.end());
+        for (int v = 0; v < 120; ++v) REQUIRE(sorted[v] == v);
+        Graph r = d.relabeled(order);
+        std::vector<int> position(120);
+        for (int i = 0; i < 120; ++i) position[order[i]] = i;
+
+        CHECK(r.getNumEdges() == d.getNumEdges());
+        CHECK(r.hasEulerCircuit() == d.hasEulerCircuit());
+        auto comps = r.findSCCs();
+        for (auto& c : comps)
+            for (int& v : c) v = order[v];
+        CHECK(sorted_sccs(comps) == sorted_sccs(d.findSCCs()));
+        CHECK(r.maxFlows({{position[0], position[119]}, {position[5], position[7]}}) == d.maxFlows({{0, 119}, {5, 7}}));
+        CHECK(r.countCliques(&order) == d.countCliques());
+    }
+}
+
+TEST_CASE("CompressedGraph: neighbors decode back and algorithms match Graph") {
+    Graph g(300, false);
+    g.addEdge(0, 299); // Gap needing a two-byte varint
+    g.addEdge(0, 1);
+    g.addEdge(5, 130);
+    CompressedGraph c(g);
+    CHECK(c.degree(0) == 2);
+    std::vector<int> n0(c.neighbors(0).begin(), c.neighbors(0).end());
+    CHECK(n0 == std::vector<int>({1, 299}));
+    CHECK(c.neighbors(2).begin() == c.neighbors(2).end());
+    CHECK(c.getNumEdges() == 3);
+    CHECK_THROWS_AS(c.neighbors(300), std::invalid_argument);
+
+    for (int seed = 1; seed <= 6; ++seed) {
+        bool directed = seed % 2 == 0;
+        Graph r(200, directed);
+        srand(seed);
+        for (int i = 0; i < 150 * seed; ++i) {
+            int a = rand() % 200, b = rand() % 200;
+            if (a != b) r.addEdge(a, b);
+        }
+        CompressedGraph cr(r);
+        for (int v = 0; v < 200; ++v) {
+            std::vector<int> expected = r.getNeighbors(v);
+            std::sort(expected.begin(), expected.end());
+            CHECK(std::vector<int>(cr.neighbors(v).begin(), cr.neighbors(v).end()) == expected);
+        }
+        CHECK(cr.mstWeight() == r.mstWeight());
+        CHECK(cr.hasEulerCircuit() == r.hasEulerCircuit());
+        CHECK(sorted_sccs(cr.findSCCs()) == sorted_sccs(r.findSCCs()));
+        auto dist = cr.bfsDistances(0);
+        CHECK(dist[0] == 0);
+        for (int v : r.getNeighbors(0)) CHECK(dist[v] == 1);
+    }
+}
+
+TEST_CASE("CompressedGraph: built from an edge list, about a byte per neighbor on a relabeled path") {
+    const int n = 100000;
+    std::vector<std::pair<int, int>> edges;
+    for (int v = 0; v + 1 < n; ++v) edges.push_back({v + 1, v});
+    edges.push_back({0, 1}); // Duplicate of an undirected edge
+    CompressedGraph path(n, false, edges);
+    CHECK(path.getNumEdges() == n - 1);
+    CHECK(path.mstWeight() == n - 1);
+    CHECK(path.bfsDistances(0)[n - 1] == n - 1);
+    CHECK_FALSE(path.hasEulerCircuit());
+    CHECK(path.memoryBytes() <= static_cast<size_t>(n + 1) * (8 + 3)); // Offset, then a byte for degree, first neighbor and gap
+
+    edges.pop_back();
+    edges.push_back({0, n - 1}); // Close the cycle n-1 -> ... -> 0 -> n-1
+    CompressedGraph cycle(n, true, edges);
+    CHECK(cycle.hasEulerCircuit());
+    CHECK(cycle.findSCCs().size() == 1); // Deep DFS without recursion
+    CHECK(cycle.mstWeight() == -1);
+    CHECK_THROWS_AS(CompressedGraph(3, false, {{0, 3}}), std::invalid_argument);
+    CHECK_THROWS_AS(CompressedGraph(3, true, {{1, 1}}), std::invalid_argument);
+}
+
+TEST_CASE("CompressedGraph::Builder: sorted arcs only, undirected edges in both directions") {
+    CompressedGraph::Builder out(5, true);
+    out.addArc(0, 3);
+    out.addArc(0, 4);
+    out.addArc(3, 0); // Vertices 1 and 2 get empty rows
+    CHECK_THROWS_AS(out.addArc(3, 0), std::invalid_argument); // Repeat
+    CHECK_THROWS_AS(out.addArc(2, 1), std::invalid_argument); // Source going back
+    CHECK_THROWS_AS(out.addArc(4, 4), std::invalid_argument);
+    CompressedGraph g = out.finish();
+    CHECK(g.getNumEdges() == 3);
+    CHECK(g.degree(1) == 0);
+    CHECK(g.degree(4) == 0);
+    CHECK(std::vector<int>(g.neighbors(0).begin(), g.neighbors(0).end()) == std::vector<int>({3, 4}));
+
+    CompressedGraph::Builder oneWay(3, false);
+    oneWay.addArc(0, 1);
+    oneWay.addArc(1, 2);
+    oneWay.addArc(2, 1);
+    CHECK_THROWS_AS(oneWay.finish(), std::invalid_argument); // 0 -> 1 has no 1 -> 0
+    CompressedGraph::Builder mismatched(3, false); // Right number of arcs each way, but 0 -> 1 and 2 -> 1
+    mismatched.addArc(0, 1);
+    CHECK_THROWS_AS(mismatched.addArc(2, 1), std::invalid_argument);
+    CHECK(CompressedGraph::Builder(0, false).finish().getNumVertices() == 0);
+}
+
+TEST_CASE("Graph file: write, mmap and rebuild the same graph") {
+    const std::string path = "test_graph_file.csr";
+    for (bool directed : {false, true}) {
+        Graph g(50, directed);
+        srand(directed ? 3 : 4);
+        for (int i = 0; i < 120; ++i) {
+            int a = rand() % 50, b = rand() % 50;
+            if (a != b) g.addEdge(a, b);
+        }
+        writeGraphFile(path, g);
+        MappedGraph m(path);
+        CHECK(m.getNumVertices() == 50);
+        CHECK(m.isDirected() == directed);
+        CHECK_FALSE(m.hasWeights());
+        CHECK(m.getNumArcs() == static_cast<uint64_t>(g.getNumEdges() * (directed ? 1 : 2)));
+        for (int v = 0; v < 50; ++v) {
+            std::vector<int> expected = g.getNeighbors(v);
+            std::sort(expected.begin(), expected.end());
+            auto [first, last] = m.neighbors(v);
+            CHECK(std::vector<int>(first, last) == expected);
+        }
+        Graph back = m.toGraph();
+        CHECK(back.getNumEdges() == g.getNumEdges());
+        CHECK(back.hasEulerCircuit() == g.hasEulerCircuit());
+        CHECK(sorted_sccs(back.findSCCs()) == sorted_sccs(g.findSCCs()));
+        CHECK(back.maxFlows({{0, 49}, {7, 3}}) == g.maxFlows({{0, 49}, {7, 3}}));
+        CHECK(back.mstWeight() == g.mstWeight());
+        CompressedGraph packed = m.toCompressed(); // Streamed from the mapping, no Graph in between
+        CHECK(packed.getNumEdges() == g.getNumEdges());
+        for (int v = 0; v < 50; ++v) {
+            auto [first, last] = m.neighbors(v);
+            CHECK(std::vector<int>(packed.neighbors(v).begin(), packed.neighbors(v).end()) == std::vector<int>(first, last));
+        }
+        CHECK(packed.findSCCs() == back.findSCCs()); // Same Kosaraju code and the same (sorted) rows: same order
+        CHECK(packed.mstWeight() == g.mstWeight());
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Graph file: weights, corruption and bad input") {
+    const std::string path = "test_graph_file_w.csr";
+    Graph g(3, false);
+    g.addEdge(0,1); g.addEdge(1,2);
+    std::vector<int32_t> weights = {5, 5, 7, 7}; // Arcs 0->1, 1->0, 1->2, 2->1
+    std::vector<int32_t> tooFew = {1};
+    CHECK_THROWS_AS(writeGraphFile(path, g, &tooFew), std::invalid_argument);
+    writeGraphFile(path, g, &weights);
+    {
+        MappedGraph m(path);
+        REQUIRE(m.hasWeights());
+        CHECK(std::vector<int32_t>(m.weights(), m.weights() + 4) == weights);
+        MappedGraph moved = std::move(m);
+        CHECK(moved.degree(1) == 2);
+    }
+
+    // Flip one target byte: the checksum catches it, unverified opens trust the contents
+    std::fstream f(path, std::ios::in | std::ios::out | std::ios::binary);
+    f.seekp(sizeof(GraphFileHeader) + 4 * sizeof(uint64_t));
+    f.put(2);
+    f.close();
+    CHECK_THROWS_AS(MappedGraph{path}, std::invalid_argument);
+    CHECK(MappedGraph(path, false).neighbors(0).first[0] == 2);
+    CHECK_THROWS_AS(MappedGraph(path, false).toCompressed(), std::invalid_argument); // 0 -> 2 but 2 -> 1 only
+    CHECK_THROWS_AS(MappedGraph(path, false).toGraph(), std::invalid_argument);
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a graph";
+    CHECK_THROWS_AS(MappedGraph{path}, std::invalid_argument);
+    std::remove(path.c_str());
+    CHECK_THROWS_AS(MappedGraph{path}, std::system_error);
+
+    uint64_t offset[] = {0, 1, 1};
+    uint32_t target[] = {0};
+    CHECK_THROWS_AS(Graph::fromCSR(2, true, offset, target), std::invalid_argument); // Self loop
+    uint32_t unsorted[] = {1, 1};
+    uint64_t twice[] = {0, 2, 2};
+    CHECK_THROWS_AS(Graph::fromCSR(2, true, twice, unsorted), std::invalid_argument);
+}
+
+static Graph import_text(const std::string& text, GraphFormat format, bool directed = false, int threads = 1) {
+    return importGraph(text.data(), text.size(), format, directed, threads);
+}
+
+TEST_CASE("importGraph: edge list, DIMACS and METIS describe the same graph") {
+    Graph edges = import_text("# triangle plus a tail\n0 1\n1 2 7\r\n2 0\n\n2 3\n1 0\n", GraphFormat::EdgeList);
+    Graph dimacs = import_text("c triangle plus a tail\np sp 4 4\na 1 2 1\na 2 3 7\ne 3 1\na 3 4 2\n", GraphFormat::Dimacs);
+    Graph metis = import_text("% triangle plus a tail\n4 4\n2 3\n1 3\n1 2 4\n3\n", GraphFormat::Metis);
+    Graph weighted = import_text("4 4 011 2\n5 6 2 9 3 9\n5 6 1 9 3 9\n5 6 1 9 2 9 4 9\n5 6 3 9\n", GraphFormat::Metis);
+    for (const Graph* g : {&edges, &dimacs, &metis, &weighted}) {
+        CHECK(g->getNumVertices() == 4);
+        CHECK(g->getNumEdges() == 4); // Duplicates dropped
+        CHECK(g->getNeighbors(3) == std::vector<int>({2}));
+        CHECK(g->mstWeight() == 3);
+    }
+    Graph directed = import_text("0 1\n1 0\n1 2\n", GraphFormat::EdgeList, true);
+    CHECK(directed.getNumEdges() == 3);
+    CHECK(sorted_sccs(directed.findSCCs()) == std::vector<std::vector<int>>({{0, 1}, {2}}));
+    CHECK(import_text("", GraphFormat::EdgeList).getNumVertices() == 0);
+    Graph indented = import_text("  c indented lines\n\tp sp 3 2\n a 1 2\n\te 2 3\n", GraphFormat::Dimacs);
+    CHECK(indented.getNumEdges() == 2);
+}
+
+TEST_CASE("importGraph: malformed lines are reported with their number") {
+    CHECK_THROWS_WITH_AS(import_text("0 1\n1 x\n", GraphFormat::EdgeList), "Error: Malformed input at line 2.\n",
+                         std::invalid_argument);
+    CHECK_THROWS_WITH_AS(import_text("0 1\n2 2\n", GraphFormat::EdgeList), "Error: Self loop at line 2.\n",
+                         std::invalid_argument);
+    CHECK_THROWS_WITH_AS(import_text("p sp 2 1\nz 1 2\n", GraphFormat::Dimacs), "Error: Malformed input at line 2.\n",
+                         std::invalid_argument);
+    CHECK_THROWS_AS(import_text("a 1 2\n", GraphFormat::Dimacs), std::invalid_argument); // No problem line
+    CHECK_THROWS_WITH_AS(import_text("c ids from 1\np sp 2 1\na 1 3\n", GraphFormat::Dimacs),
+                         "Error: Invalid vertex index at line 3.\n", std::invalid_argument);
+    CHECK_THROWS_WITH_AS(import_text("p sp 2 1\na 2 2\n", GraphFormat::Dimacs), "Error: Self loop at line 2.\n",
+                         std::invalid_argument);
+    CHECK_THROWS_WITH_AS(import_text("p sp 2 1\na 1 2 5 x\n", GraphFormat::Dimacs), "Error: Malformed input at line 2.\n",
+                         std::invalid_argument); // Nothing may follow the weight
+    CHECK_THROWS_WITH_AS(import_text("p sp 2 1\ne 1 2\np sp 3 1\n", GraphFormat::Dimacs),
+                         "Error: Malformed input at line 3.\n", std::invalid_argument); // Second problem line
+    CHECK_THROWS_WITH_AS(import_text("2 1\n3\n\n", GraphFormat::Metis), "Error: Invalid vertex index at line 2.\n",
+                         std::invalid_argument);
+    CHECK_THROWS_WITH_AS(import_text("2 1\n2\n1\n1\n", GraphFormat::Metis), "Error: Malformed input at line 4.\n",
+                         std::invalid_argument); // More vertex lines than n
+    CHECK_THROWS_AS(import_text("% only a comment\n", GraphFormat::Metis), std::invalid_argument);
+    // Ids and counts past 2^20 vertices are refused before anything is allocated for them
+    CHECK_THROWS_WITH_AS(import_text("0 1\n0 4000000000\n", GraphFormat::EdgeList),
+                         "Error: Invalid vertex index at line 2.\n", std::invalid_argument);
+    CHECK(import_text("0 1048575\n", GraphFormat::EdgeList).getNumVertices() == 1 << 20);
+    CHECK_THROWS_WITH_AS(import_text("0 1048576\n", GraphFormat::EdgeList), "Error: Invalid vertex index at line 1.\n",
+                         std::invalid_argument);
+    CHECK_THROWS_WITH_AS(import_text("c big\np sp 2000000000 1\n", GraphFormat::Dimacs),
+                         "Error: Too many vertices at line 2.\n", std::invalid_argument);
+    CHECK_THROWS_WITH_AS(import_text("2000000000 0\n", GraphFormat::Metis), "Error: Too many vertices at line 1.\n",
+                         std::invalid_argument);
+}
+
+TEST_CASE("fromCSR: an undirected row without its mirror arc throws") {
+    const uint64_t offset[] = {0, 1, 2, 2};
+    const uint32_t oneWay[] = {1, 2}; // 0 -> 1 and 1 -> 2, no 1 -> 0 or 2 -> 1
+    CHECK_THROWS_AS(Graph::fromCSR(3, false, offset, oneWay), std::invalid_argument);
+    CHECK(Graph::fromCSR(3, true, offset, oneWay).getNumEdges() == 2);
+    const uint64_t backOffset[] = {0, 0, 1, 1};
+    const uint32_t backOnly[] = {0}; // 1 -> 0 only
+    CHECK_THROWS_AS(Graph::fromCSR(3, false, backOffset, backOnly), std::invalid_argument);
+    const uint64_t pairOffset[] = {0, 1, 2, 2};
+    const uint32_t both[] = {1, 0};
+    CHECK(Graph::fromCSR(3, false, pairOffset, both).getNumEdges() == 1);
+}
+
+TEST_CASE("importGraph: parallel chunks give the same graph as one thread") {
+    std::string edgeList, metis;
+    const int n = 200000;
+    for (int v = 0; v < n; ++v) edgeList += std::to_string(v) + " " + std::to_string((v + 1) % n) + "\n";
+    metis = std::to_string(n) + " " + std::to_string(n) + "\n% ring\n";
+    for (int v = 1; v <= n; ++v) {
+        metis += std::to_string(v == 1 ? n : v - 1) + " " + std::to_string(v == n ? 1 : v + 1) + "\n";
+        if (v % 1000 == 0) metis += "% comment between vertex lines\n";
+    }
+    while (edgeList.size() < (5u << 20)) edgeList += "# padding to cross the parallel threshold\n";
+    while (metis.size() < (5u << 20)) metis += "% padding\n";
+    for (GraphFormat format : {GraphFormat::EdgeList, GraphFormat::Metis}) {
+        const std::string& text = format == GraphFormat::EdgeList ? edgeList : metis;
+        Graph one = import_text(text, format, false, 1);
+        Graph many = import_text(text, format, false, 4);
+        CHECK(one.getNumVertices() == n);
+        CHECK(many.getNumEdges() == one.getNumEdges());
+        CHECK(many.getNumEdges() == n);
+        for (int v = 0; v < n; v += 997) CHECK(many.getNeighbors(v) == one.getNeighbors(v));
+        CHECK(many.hasEulerCircuit());
+    }
+    const std::string path = "test_import.txt";
+    std::ofstream(path) << "0 1\n1 2\n2 0\n";
+    CHECK(importGraphFile(path, GraphFormat::EdgeList).hasEulerCircuit());
+    std::remove(path.c_str());
+    CHECK_THROWS_AS(importGraphFile(path, GraphFormat::EdgeList), std::system_error);
+}
+
+TEST_CASE("Graph copies share rows until one side writes") {
+    const int n = 3000; // Edge table spans several blocks
+    Graph g(n, false);
+    for (int v = 0; v < n; ++v) g.addEdge(v, (v + 1) % n);
+    Graph snap = g;
+    CHECK(&snap.getNeighbors(5) == &g.getNeighbors(5)); // Shared, nothing copied
+    g.removeEdge(5, 9); // No such edge: the rows of 5 are only read
+    CHECK(&snap.getNeighbors(5) == &g.getNeighbors(5));
+
+    g.removeEdge(0, 1); // Moves the last edge id into the freed one
+    g.addEdge(0, 2);
+    CHECK(&snap.getNeighbors(5) == &g.getNeighbors(5)); // Untouched rows stay shared
+    CHECK(&snap.getNeighbors(0) != &g.getNeighbors(0));
+    CHECK(snap.getNeighbors(0) == std::vector<int>({1, n - 1}));
+    CHECK(snap.getNumEdges() == n);
+    CHECK(snap.hasEulerCircuit());
+    CHECK(snap.isEulerCircuit(snap.findEulerCircuit()));
+    CHECK(g.getNumEdges() == n);
+    CHECK_FALSE(g.hasEulerCircuit());
+
+    g.removeAllEdges();
+    CHECK(g.getNumEdges() == 0);
+    CHECK(snap.getNeighbors(n - 1) == std::vector<int>({n - 2, 0}));
+    CHECK(snap.isEulerCircuit(snap.findEulerCircuitParallel(0, 2)));
+}
+
+TEST_CASE("StopToken: long algorithms return early with partial results") {
+    const int n = 40;
+    Graph complete(n, false); // 2^40 - 1 cliques
+    for (int u = 0; u < n; ++u)
+        for (int v = u + 1; v < n; ++v) complete.addEdge(u, v);
+    StopToken expiring(StopToken::Clock::now() + std::chrono::milliseconds(20));
+    uint64_t partial = complete.countCliques(nullptr, &expiring);
+    CHECK(expiring.reason() == StopToken::Reason::Expired);
+    CHECK(partial > 0);
+    CHECK(partial < (uint64_t(1) << n) - 1);
+    uint64_t small = SmallGraph<>(complete).countCliques(&expiring);
+    CHECK(small < (uint64_t(1) << n) - 1);
+
+    auto parent = std::make_shared<StopToken>();
+    StopToken child(StopToken::Clock::time_point::max(), parent);
+    CHECK_FALSE(child.stopRequested());
+    CHECK(complete.findSCCs(nullptr, &child).size() == 1);
+    CHECK(complete.maxFlows({{0, n - 1}}, 1, nullptr, &child) == std::vector<int64_t>({n - 1}));
+    parent->cancel();
+    CHECK(child.reason() == StopToken::Reason::Cancelled);
+    CHECK(complete.mstWeight(nullptr, &child) == 0);
+    CHECK(complete.findSCCs(nullptr, &child).empty());
+    CHECK(complete.maxFlows({{0, n - 1}, {1, 2}}, 1, nullptr, &child) == std::vector<int64_t>({0, 0}));
+    CHECK(complete.countCliques(nullptr, &child) == 0);
+}
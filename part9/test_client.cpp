@@ -66,8 +66,8 @@ TEST_CASE("send_request: invalid choice then 1 (manual graph) writes expected in
     int fds[2]; REQUIRE(::pipe(fds) == 0);
     int r = fds[0], w = fds[1];
 
-    // Sequence: invalid 5 → valid 1 → V=3 → edges: 0 1, 1 2, -1 -1
-    std::istringstream iss("5\n1\n3\n0 1\n1 2\n-1 -1\n");
+    // Sequence: invalid 9 → valid 1 → V=3 → edges: 0 1, 1 2, -1 -1
+    std::istringstream iss("9\n1\n3\n0 1\n1 2\n-1 -1\n");
     CinReplacer cr(std::cin, iss.rdbuf());
 
     bool ok = send_request(w);
@@ -109,6 +109,76 @@ TEST_CASE("send_request: choice=2 (random graph) writes V,E,seed") {
     ::close(r); ::close(w);
 }
 
+TEST_CASE("send_request: choice=4 (random graph + flow pairs) writes V,E,seed and pairs") {
+    int fds[2]; REQUIRE(::pipe(fds) == 0);
+    int r = fds[0], w = fds[1];
+
+    std::istringstream iss("4\n5\n4\n7\n2\n0 4\n1 3\n");
+    CinReplacer cr(std::cin, iss.rdbuf());
+
+    bool ok = send_request(w);
+    CHECK(ok == true);
+
+    std::string raw = read_exact_bytes(r, sizeof(int) * 9);
+    CHECK(raw.size() == sizeof(int) * 9);
+
+    const int* p = reinterpret_cast<const int*>(raw.data());
+    CHECK(p[0] == 4);
+    CHECK(p[1] == 5);
+    CHECK(p[2] == 4);
+    CHECK(p[3] == 7);
+    CHECK(p[4] == 2);
+    CHECK(p[5] == 0); CHECK(p[6] == 4);
+    CHECK(p[7] == 1); CHECK(p[8] == 3);
+
+    ::close(r); ::close(w);
+}
+
+TEST_CASE("send_request: choice=5 (graph file) writes the path and pairs") {
+    int fds[2]; REQUIRE(::pipe(fds) == 0);
+    int r = fds[0], w = fds[1];
+
+    std::istringstream iss("5\n/tmp/g.csr\n1\n0 3\n");
+    CinReplacer cr(std::cin, iss.rdbuf());
+
+    bool ok = send_request(w);
+    CHECK(ok == true);
+
+    std::string raw = read_exact_bytes(r, sizeof(int) * 2 + 10 + sizeof(int) * 3);
+    REQUIRE(raw.size() == sizeof(int) * 5 + 10);
+    const int* p = reinterpret_cast<const int*>(raw.data());
+    CHECK(p[0] == 5);
+    CHECK(p[1] == 10);
+    CHECK(raw.substr(8, 10) == "/tmp/g.csr");
+    const int* q = reinterpret_cast<const int*>(raw.data() + 18);
+    CHECK(q[0] == 1);
+    CHECK(q[1] == 0); CHECK(q[2] == 3);
+
+    ::close(r); ::close(w);
+}
+
+TEST_CASE("send_request: choice=7 (random graph + pairs + algorithm mask) writes the mask last") {
+    int fds[2]; REQUIRE(::pipe(fds) == 0);
+    int r = fds[0], w = fds[1];
+
+    std::istringstream iss("7\n5\n4\n7\n1\n0 4\n4\n");
+    CinReplacer cr(std::cin, iss.rdbuf());
+
+    bool ok = send_request(w);
+    CHECK(ok == true);
+
+    std::string raw = read_exact_bytes(r, sizeof(int) * 8);
+    REQUIRE(raw.size() == sizeof(int) * 8);
+    const int* p = reinterpret_cast<const int*>(raw.data());
+    CHECK(p[0] == 7);
+    CHECK(p[1] == 5); CHECK(p[2] == 4); CHECK(p[3] == 7);
+    CHECK(p[4] == 1);
+    CHECK(p[5] == 0); CHECK(p[6] == 4);
+    CHECK(p[7] == 4); // SCCs only
+
+    ::close(r); ::close(w);
+}
+
 TEST_CASE("send_request: choice=0 is written and function returns false") {
     int fds[2]; REQUIRE(::pipe(fds) == 0);
     int r = fds[0], w = fds[1];
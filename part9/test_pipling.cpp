@@ -3,8 +3,15 @@
 
 #include "pipling.hpp"
 #include "graph.hpp"
+#include "ring_queue.hpp"
 
 #include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <chrono>
 
@@ -89,3 +96,535 @@ TEST_CASE("Pipling: destructor calls stop() — no deadlock even without jobs")
     }
     CHECK(true);
 }
+
+TEST_CASE("Pipling: submit with explicit (source, sink) pairs") {
+    Graph g(4, true);
+    g.addEdge(0,1);
+    g.addEdge(1,3);
+    g.addEdge(0,2);
+    g.addEdge(2,3);
+
+    Pipling p;
+    p.start();
+    CHECK_THROWS_AS(p.submit(g, {{0,9}}), std::invalid_argument);
+    p.submit(g, {{0,3}, {1,3}, {3,0}});
+    Pipling::Result r = p.get();
+    p.stop();
+    CHECK(r.max_flows == std::vector<int64_t>({2, 1, 0}));
+    CHECK(r.max_flow == 2);
+    CHECK(r.flow_pairs.size() == 3);
+}
+
+TEST_CASE("Pipling: 64-vertex jobs take the bitmask path, 65 vertices the general one, same results") {
+    Pipling p;
+    p.start();
+    for (int n : {64, 65}) {
+        Graph g(n, false); // Cycle plus one chord
+        for (int v = 0; v < n; ++v) g.addEdge(v, (v + 1) % n);
+        g.addEdge(0, n / 2);
+        p.submit(g, {{0, n / 2}, {1, n - 1}});
+        Pipling::Result r = p.get();
+        CHECK(r.mst_weight == n - 1);
+        CHECK(r.num_cliques == static_cast<uint64_t>(2 * n + 1));
+        CHECK(r.sccs.size() == 1);
+        CHECK(r.max_flows == std::vector<int64_t>({3, 2}));
+    }
+    p.stop();
+}
+
+TEST_CASE("Pipling: relabeled layouts report results in client ids") {
+    Graph g(100, true); // Two directed cycles joined by one edge, flows around scrambled ids
+    for (int v = 0; v < 50; ++v) g.addEdge((v * 7) % 50, ((v + 1) * 7) % 50);
+    for (int v = 0; v < 50; ++v) g.addEdge(50 + (v * 3) % 50, 50 + ((v + 1) * 3) % 50);
+    g.addEdge(49, 99);
+    std::vector<std::pair<int, int>> pairs = {{0, 99}, {99, 0}, {14, 21}};
+
+    Pipling plain;
+    plain.start();
+    plain.submit(g, pairs);
+    Pipling::Result expected = plain.get();
+    plain.stop();
+    sort_components(expected.sccs);
+    for (auto kind : {Graph::VertexOrder::DegreeDescending, Graph::VertexOrder::ReverseCuthillMcKee,
+                      Graph::VertexOrder::Bfs}) {
+        Pipling p(kind);
+        p.start();
+        p.submit(g, pairs);
+        Pipling::Result r = p.get();
+        p.stop();
+        sort_components(r.sccs);
+        CHECK(r.sccs == expected.sccs);
+        CHECK(r.num_cliques == expected.num_cliques);
+        CHECK(r.max_flows == expected.max_flows);
+        CHECK(r.flow_pairs == pairs);
+    }
+    CHECK(expected.sccs.size() == 2);
+    CHECK(expected.max_flows == std::vector<int64_t>({1, 0, 1}));
+}
+
+TEST_CASE("Pipling: a submitted graph is a snapshot, later edits by the caller don't reach the job") {
+    const int n = 100; // Above SmallGraph size
+    Graph ring(n, true);
+    for (int v = 0; v < n; ++v) ring.addEdge(v, (v + 1) % n);
+
+    Pipling p(Graph::VertexOrder::ReverseCuthillMcKee);
+    p.start();
+    p.submit(ring);
+    ring.removeEdge(n - 1, 0); // The job still sees the full ring
+    Graph path = ring;
+    p.submit(std::move(path));
+    Pipling::Result before = p.get();
+    Pipling::Result after = p.get();
+    p.stop();
+
+    REQUIRE(before.sccs.size() == 1);
+    CHECK(before.sccs[0].size() == n);
+    CHECK(before.max_flow == 1);
+    CHECK(after.sccs.size() == n);
+    CHECK(after.max_flow == 1);
+}
+
+TEST_CASE("Pipling: callers on several threads share one pipeline, each callback gets its own result") {
+    Pipling p(Graph::VertexOrder::ReverseCuthillMcKee);
+    p.start();
+    const int callers = 8;
+    std::vector<int64_t> mst(callers, -2);
+    std::vector<int> sink(callers, -1);
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+    for (int c = 0; c < callers; ++c) {
+        threads.emplace_back([&, c] {
+            int n = 10 + 20 * c; // Both sides of the SmallGraph limit
+            Graph path(n, false);
+            for (int v = 0; v + 1 < n; ++v) path.addEdge(v, v + 1);
+            p.submit(std::move(path), {}, [&, c](Pipling::Result r) {
+                mst[c] = r.mst_weight;
+                sink[c] = r.flow_pairs.front().second;
+                finished++;
+            });
+        });
+    }
+    for (auto& t : threads) t.join();
+    p.stop(); // Drains the queued jobs first
+    CHECK(finished == callers);
+    for (int c = 0; c < callers; ++c) {
+        CHECK(mst[c] == 9 + 20 * c);
+        CHECK(sink[c] == 9 + 20 * c);
+    }
+}
+
+TEST_CASE("Pipling: submitAsync futures are matched to their own jobs by id, in any waiting order") {
+    Pipling p;
+    p.start();
+    std::vector<Pipling::Ticket> tickets;
+    for (int n = 3; n <= 80; n += 7) { // Undirected paths, mixed with a get()-style job
+        Graph path(n, false);
+        for (int v = 0; v + 1 < n; ++v) path.addEdge(v, v + 1);
+        tickets.push_back(p.submitAsync(path));
+        if (n == 10) {
+            uint64_t plainId = p.submit(path);
+            CHECK(p.get().job_id == plainId);
+        }
+    }
+    for (size_t i = 1; i < tickets.size(); ++i) CHECK(tickets[i].id > tickets[i - 1].id);
+    for (size_t i = tickets.size(); i-- > 0;) { // Newest first
+        Pipling::Result r = tickets[i].result.get();
+        int n = 3 + 7 * static_cast<int>(i);
+        CHECK(r.job_id == tickets[i].id);
+        CHECK(r.mst_weight == n - 1);
+        CHECK(r.flow_pairs.front() == std::pair<int, int>(0, n - 1));
+    }
+    p.stop();
+
+    Pipling::Ticket orphan;
+    { // Never started: dropping the queued job breaks its promise instead of hanging the waiter
+        Pipling lost;
+        orphan = lost.submitAsync(Graph(2, false));
+    }
+    CHECK_THROWS_AS(orphan.result.get(), std::future_error);
+}
+
+TEST_CASE("Pipling: get() keeps submission order when the stages of different jobs finish at different times") {
+    Pipling p;
+    p.start();
+    std::vector<int> sizes;
+    for (int k = 0; k < 12; ++k) {
+        int n = k % 3 == 0 ? 18 : 70 + k; // Clique-heavy complete graphs between cheap paths
+        Graph g(n, false);
+        if (k % 3 == 0) {
+            for (int u = 0; u < n; ++u)
+                for (int v = u + 1; v < n; ++v) g.addEdge(u, v);
+        } else {
+            for (int v = 0; v + 1 < n; ++v) g.addEdge(v, v + 1);
+        }
+        sizes.push_back(n);
+        p.submit(std::move(g));
+    }
+    for (int k = 0; k < 12; ++k) {
+        Pipling::Result r = p.get();
+        int n = sizes[k];
+        CHECK(r.mst_weight == n - 1);
+        CHECK(r.flow_pairs.front().second == n - 1);
+        CHECK(r.max_flow == (k % 3 == 0 ? n - 1 : 1));
+        CHECK(r.num_cliques == (k % 3 == 0 ? (1ull << n) - 1 : static_cast<uint64_t>(2 * n - 1)));
+    }
+    p.stop();
+}
+
+TEST_CASE("Pipling: replicated stages from a config file give the same results as one worker per stage") {
+    const std::string path = "test_pipling.conf";
+    std::ofstream(path) << "# stage threads\ncliques 4\nflow 2   # two max flow workers\norder rcm\n";
+    Pipling::Config config = Pipling::Config::load(path);
+    CHECK(config.workers == std::array<int, Pipling::STAGES>({1, 4, 1, 2}));
+    CHECK(config.order == Graph::VertexOrder::ReverseCuthillMcKee);
+    CHECK_FALSE(config.adaptive);
+    std::ofstream(path) << "adaptive on\nrebalance_ms 5\nqueue_capacity 64\noverflow drop_oldest\njob_timeout_ms 250\n"
+                           "max_batch 8\n";
+    Pipling::Config adaptive = Pipling::Config::load(path);
+    CHECK(adaptive.queueCapacity == 64);
+    CHECK(adaptive.overflow == Pipling::Overflow::DropOldest);
+    CHECK(adaptive.adaptive);
+    CHECK(adaptive.rebalancePeriod == std::chrono::milliseconds(5));
+    CHECK(adaptive.jobTimeout == std::chrono::milliseconds(250));
+    CHECK(adaptive.maxBatch == 8);
+    std::ofstream(path) << "cliques many\n";
+    CHECK_THROWS_AS(Pipling::Config::load(path), std::invalid_argument);
+    std::ofstream(path) << "scc 0\n";
+    CHECK_THROWS_AS(Pipling::Config::load(path), std::invalid_argument);
+    std::ofstream(path) << "queue_capacity 0\n";
+    CHECK_THROWS_AS(Pipling::Config::load(path), std::invalid_argument);
+    std::ofstream(path) << "max_batch 0\n";
+    CHECK_THROWS_AS(Pipling::Config::load(path), std::invalid_argument);
+    std::remove(path.c_str());
+    CHECK_THROWS_AS(Pipling::Config::load(path), std::invalid_argument);
+
+    config.queueCapacity = 2; // Submitters wait for room most of the time
+    Pipling replicated(config);
+    replicated.start();
+    std::vector<Pipling::Ticket> tickets;
+    for (int k = 0; k < 16; ++k) {
+        int n = 12 + 7 * k;
+        Graph g(n, false); // Cycle with chords: several workers of a stage run at once
+        for (int v = 0; v < n; ++v) g.addEdge(v, (v + 1) % n);
+        for (int v = 0; v + 3 < n; v += 3) g.addEdge(v, v + 3);
+        if (k % 2) tickets.push_back(replicated.submitAsync(g));
+        else replicated.submit(g);
+    }
+    for (int k = 0; k < 16; ++k) {
+        int n = 12 + 7 * k;
+        Pipling::Result r = k % 2 ? tickets[k / 2].result.get() : replicated.get(); // get() keeps submission order
+        CHECK(r.mst_weight == n - 1);
+        CHECK(r.flow_pairs.front().second == n - 1);
+        CHECK(r.sccs.size() == 1);
+    }
+    replicated.stop();
+}
+
+// Keep the clique stage backed up until the monitor gives it another worker or the deadline passes. Polls rather
+// than sleeping a fixed time: when a move happens depends on the scheduler, not on the test.
+static bool cliquesGetAnotherWorker(Pipling& p, const Graph& heavy, uint64_t cliques) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(20);
+    std::vector<Pipling::Ticket> tickets;
+    bool moved = false;
+    while (!moved && std::chrono::steady_clock::now() < deadline) {
+        size_t pending = std::count_if(tickets.begin(), tickets.end(), [](const Pipling::Ticket& t) {
+            return t.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+        });
+        if (pending < 16) tickets.push_back(p.submitAsync(heavy));
+        else std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        moved = p.workerCounts()[Pipling::Cliques] > 1;
+    }
+    for (auto& t : tickets) CHECK(t.result.get().num_cliques == cliques);
+    return moved;
+}
+
+TEST_CASE("Pipling: adaptive workers move to the clique stage when it backs up, also after a restart") {
+    Pipling::Config config;
+    config.workers = {2, 1, 2, 2};
+    config.adaptive = true;
+    config.rebalancePeriod = std::chrono::milliseconds(2);
+    Pipling p(config);
+    const int n = 20;
+    Graph complete(n, false);
+    for (int u = 0; u < n; ++u)
+        for (int v = u + 1; v < n; ++v) complete.addEdge(u, v);
+    for (int round = 0; round < 2; ++round) { // The second round checks that stop() didn't leave the monitor off
+        p.start();
+        CHECK(p.workerCounts() == config.workers);
+        CHECK(cliquesGetAnotherWorker(p, complete, (1ull << n) - 1));
+        std::array<int, Pipling::STAGES> counts = p.workerCounts();
+        CHECK(counts[0] + counts[1] + counts[2] + counts[3] == 7); // Same budget
+        for (int c : counts) CHECK(c >= 1);
+        p.stop(); // Joins every worker, wherever it moved
+    }
+}
+
+TEST_CASE("RingQueue: many producers and consumers through a small ring lose and repeat nothing") {
+    RingQueue<int> q(5);
+    CHECK(q.capacity() == 8);
+    int v = 1;
+    for (int i = 0; i < 8; ++i) CHECK(q.tryPush(v));
+    CHECK_FALSE(q.tryPush(v)); // Full
+    CHECK(q.size() == 8);
+    for (int i = 0; i < 8; ++i) CHECK(q.tryPop(v));
+    CHECK_FALSE(q.tryPop(v)); // Empty
+
+    const int producers = 4, consumers = 3, each = 20000;
+    std::vector<std::atomic<int>> seen(producers * each);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&, p] { for (int i = 0; i < each; ++i) q.push(p * each + i); });
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&] {
+            for (;;) {
+                int x = q.pop();
+                if (x < 0) break; // One stop value per consumer
+                seen[x]++;
+            }
+        });
+    }
+    for (int p = 0; p < producers; ++p) threads[p].join();
+    for (int c = 0; c < consumers; ++c) q.push(-1);
+    for (size_t t = producers; t < threads.size(); ++t) threads[t].join();
+    int wrong = 0;
+    for (auto& s : seen) wrong += s != 1;
+    CHECK(wrong == 0);
+    CHECK(q.size() == 0);
+}
+
+TEST_CASE("Pipling: overflow policies when queueCapacity jobs are in flight") {
+    Graph g(3, false);
+    g.addEdge(0, 1);
+    g.addEdge(1, 2);
+    Pipling::Config config;
+    config.queueCapacity = 2;
+
+    SUBCASE("reject throws Saturated with a retry hint, and admits again once jobs finish") {
+        config.overflow = Pipling::Overflow::Reject;
+        Pipling p(config); // Not started yet: submitted jobs stay in flight
+        p.submit(g);
+        p.submit(g);
+        CHECK(p.inFlightJobs() == 2);
+        try {
+            p.submit(g);
+            FAIL("expected Saturated");
+        } catch (const Pipling::Saturated& busy) {
+            CHECK(busy.retryAfter.count() >= 1);
+        }
+        p.waitForRoom(); // Returns at once under Reject
+        p.start();
+        p.get();
+        p.get();
+        CHECK(p.inFlightJobs() == 0);
+        p.submit(g);
+        CHECK(p.get().mst_weight == 2);
+        p.stop();
+    }
+    SUBCASE("drop_oldest evicts the oldest unstarted job, which completes as Dropped") {
+        config.overflow = Pipling::Overflow::DropOldest;
+        Pipling p(config);
+        Pipling::Ticket first = p.submitAsync(g);
+        Pipling::Ticket second = p.submitAsync(g);
+        Pipling::Ticket third = p.submitAsync(g);
+        CHECK(p.inFlightJobs() == 2);
+        p.start();
+        CHECK(first.result.get().status == Pipling::Status::Dropped);
+        Pipling::Result r2 = second.result.get(), r3 = third.result.get();
+        CHECK(r2.status == Pipling::Status::Done);
+        CHECK(r3.mst_weight == 2);
+        CHECK(r3.job_id == third.id);
+        p.stop();
+        CHECK(p.inFlightJobs() == 0);
+    }
+    SUBCASE("drop_oldest never waits for queue room, even behind a stage held by a long job") {
+        config.overflow = Pipling::Overflow::DropOldest;
+        Pipling p(config); // Capacity 2: rings of 4 slots, filled by dropped jobs after a few submits
+        const int n = 40;
+        Graph complete(n, false);
+        for (int u = 0; u < n; ++u)
+            for (int v = u + 1; v < n; ++v) complete.addEdge(u, v);
+        JobOptions cliquesOnly;
+        cliquesOnly.algorithms = 1u << Pipling::Cliques;
+        JobOptions hold = cliquesOnly;
+        auto release = std::make_shared<StopToken>();
+        hold.cancel = release;
+        p.start();
+        Pipling::Ticket held = p.submitAsync(complete, {}, hold); // 2^40 cliques: the clique stage is busy until cancelled
+        std::this_thread::sleep_for(std::chrono::milliseconds(20)); // Let the worker pick it up
+
+        std::vector<Pipling::Ticket> tickets;
+        auto begin = std::chrono::steady_clock::now();
+        for (int k = 0; k < 100; ++k) tickets.push_back(p.submitAsync(g, {}, cliquesOnly));
+        CHECK(std::chrono::steady_clock::now() - begin < std::chrono::seconds(1)); // Not waiting on the held stage
+        CHECK(tickets[0].result.wait_for(std::chrono::seconds(0)) == std::future_status::ready); // Cleared out already
+        release->cancel();
+        CHECK(held.result.get().status == Pipling::Status::Cancelled);
+        int dropped = 0;
+        for (int k = 0; k < 99; ++k) dropped += tickets[k].result.get().status == Pipling::Status::Dropped;
+        CHECK(dropped == 99); // Each one evicted by the next
+        CHECK(tickets[99].result.get().num_cliques == 5);
+        p.stop();
+        CHECK(p.inFlightJobs() == 0);
+    }
+    SUBCASE("block makes the producer wait until a job finishes") {
+        config.overflow = Pipling::Overflow::Block;
+        config.queueCapacity = 1;
+        Pipling p(config);
+        p.submit(g);
+        std::atomic<bool> admitted{false};
+        std::thread producer([&] {
+            p.waitForRoom();
+            p.submit(g);
+            admitted = true;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        CHECK_FALSE(admitted);
+        p.start();
+        producer.join();
+        CHECK(admitted);
+        CHECK(p.get().mst_weight == 2);
+        CHECK(p.get().mst_weight == 2);
+        p.stop();
+    }
+}
+
+static JobOptions only(unsigned algorithms) {
+    JobOptions options;
+    options.algorithms = algorithms;
+    return options;
+}
+
+TEST_CASE("Pipling: a job with an algorithm mask only runs the selected stages") {
+    Graph g(3, true);
+    g.addEdge(0, 1); g.addEdge(1, 2); g.addEdge(2, 0);
+    Pipling p;
+    p.start();
+    Pipling::Ticket scc = p.submitAsync(g, {}, only(1u << Pipling::Scc));
+    Pipling::Ticket flowAndMst = p.submitAsync(g, {{0, 2}}, only((1u << Pipling::Flow) | (1u << Pipling::Mst)));
+    Pipling::Result r = scc.result.get();
+    CHECK(r.algorithms == (1u << Pipling::Scc));
+    CHECK(r.sccs.size() == 1);
+    CHECK(r.mst_weight == -1);
+    CHECK(r.num_cliques == 0);
+    CHECK(r.max_flow == -1);
+    Pipling::Result r2 = flowAndMst.result.get();
+    CHECK(r2.max_flow == 1);
+    CHECK(r2.sccs.empty());
+    CHECK_THROWS_AS(p.submit(g, {}, nullptr, only(0)), std::invalid_argument);
+    CHECK_THROWS_AS(p.submit(g, {}, nullptr, only(1u << Pipling::STAGES)), std::invalid_argument);
+    p.stop();
+}
+
+TEST_CASE("Pipling: cancelled and expired jobs free their stages and report partial results") {
+    Graph dense(40, false); // 2^40 - 1 cliques: hours of counting without a deadline
+    for (int u = 0; u < 40; ++u)
+        for (int v = u + 1; v < 40; ++v) dense.addEdge(u, v);
+    Graph path(3, false);
+    path.addEdge(0, 1); path.addEdge(1, 2);
+    Pipling p;
+    p.start();
+    auto begin = std::chrono::steady_clock::now();
+
+    JobOptions timed;
+    timed.deadline = begin + std::chrono::milliseconds(50);
+    Pipling::Ticket expired = p.submitAsync(dense, {}, timed);
+    Pipling::Result r = expired.result.get();
+    CHECK(r.status == Pipling::Status::TimedOut);
+    CHECK(r.num_cliques > 0);
+    CHECK(r.num_cliques < (uint64_t(1) << 40) - 1);
+
+    auto client = std::make_shared<StopToken>(); // Shared by both jobs, like the requests of one connection
+    JobOptions cancelled;
+    cancelled.cancel = client;
+    Pipling::Ticket first = p.submitAsync(dense, {}, cancelled);
+    Pipling::Ticket second = p.submitAsync(path, {}, cancelled); // Still queued behind the first one's cliques
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    client->cancel();
+    CHECK(first.result.get().status == Pipling::Status::Cancelled);
+    CHECK(second.result.get().status == Pipling::Status::Cancelled);
+    CHECK(std::chrono::steady_clock::now() - begin < std::chrono::seconds(10));
+
+    Pipling::Ticket untouched = p.submitAsync(path); // The stages are free again
+    Pipling::Result done = untouched.result.get();
+    CHECK(done.status == Pipling::Status::Done);
+    CHECK(done.mst_weight == 2);
+    p.stop();
+}
+
+TEST_CASE("RingQueue: popBatch takes what is queued, up to max and through the first control item") {
+    RingQueue<int> q(16);
+    for (int v : {1, 2, 3, -1, 5, 6}) q.push(v);
+    std::vector<int> batch;
+    auto control = [](int v) { return v < 0; };
+    q.popBatch(batch, 10, control);
+    CHECK(batch == std::vector<int>({1, 2, 3, -1}));
+    q.popBatch(batch, 1, control);
+    CHECK(batch == std::vector<int>({5}));
+    q.popBatch(batch, 10, control);
+    CHECK(batch == std::vector<int>({6}));
+
+    std::thread consumer([&] { q.popBatch(batch, 10, control); }); // Parks on the empty ring
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    q.push(7);
+    consumer.join();
+    CHECK(batch == std::vector<int>({7}));
+}
+
+TEST_CASE("Pipling: a backlog of tiny jobs is served in batches and get() keeps submission order") {
+    Pipling::Config config;
+    config.queueCapacity = 4096;
+    config.maxBatch = 64;
+    config.workers[Pipling::Mst] = 2;
+    Pipling p(config);
+    const int jobs = 2000;
+    for (int k = 0; k < jobs; ++k) { // Queued before start, so the workers find deep queues
+        Graph g(k % 5 + 2, false);
+        for (int v = 0; v + 1 < g.getNumVertices(); ++v) g.addEdge(v, v + 1);
+        p.submit(std::move(g));
+    }
+    p.start();
+    for (int k = 0; k < jobs; ++k) {
+        Pipling::Result r = p.get();
+        CHECK(r.job_id == uint64_t(k + 1));
+        CHECK(r.mst_weight == k % 5 + 1);
+        CHECK(r.max_flow == 1);
+    }
+    CHECK(p.inFlightJobs() == 0);
+    p.stop();
+}
+
+TEST_CASE("Pipling: SCCs come in the same order with or without the bitmask fast path") {
+    Pipling p(Graph::VertexOrder::ReverseCuthillMcKee);
+    p.start();
+    for (int n : {64, 65}) { // SmallGraph holds 64 vertices, 65 takes the Graph (and relabeled) path
+        Graph g(n, true);
+        for (int v = 0; v + 1 < n; ++v) g.addEdge(v, v + 1);
+        g.addEdge(5, 2);
+        std::vector<std::vector<int>> expected;
+        for (int v = 0; v < n; ++v) {
+            if (v == 2) expected.push_back({2, 3, 4, 5});
+            else if (v < 2 || v > 5) expected.push_back({v});
+        }
+        CHECK(p.submitAsync(g).result.get().sccs == expected);
+    }
+    p.stop();
+}
+
+TEST_CASE("Pipling: a job can ask for its own layout, results stay in client ids") {
+    const int n = 300;
+    Graph g(n, true);
+    for (int v = 0; v < n; ++v) {
+        g.addEdge(v, (v * 7 + 3) % n);
+        if (v % 5) g.addEdge((v * 7 + 3) % n, v);
+    }
+    Pipling p; // Original layout unless the job says otherwise
+    p.start();
+    Pipling::Result plain = p.submitAsync(g, {{0, n - 1}, {5, 17}}).result.get();
+    JobOptions rcm;
+    rcm.order = Graph::VertexOrder::ReverseCuthillMcKee;
+    Pipling::Result relabeled = p.submitAsync(g, {{0, n - 1}, {5, 17}}, rcm).result.get();
+    CHECK(relabeled.sccs == plain.sccs);
+    CHECK(relabeled.max_flows == plain.max_flows);
+    CHECK(relabeled.num_cliques == plain.num_cliques);
+    p.stop();
+}
@@ -3,6 +3,7 @@
 
 #include "pipling.hpp"
 #include "graph.hpp"
+#include "graph_file.hpp"
 #include <thread>
 #include <chrono>
 #include <string>
@@ -20,6 +21,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <sys/stat.h>
 
 // SUT
 std::string to_string(Pipling::Result res);
@@ -125,6 +127,16 @@ TEST_CASE("to_string formats fields and SCC list") {
     CHECK(s.back() == '}');
     CHECK(s.find("0 1 \n") != std::string::npos);
     CHECK(s.find("2 \n") != std::string::npos);
+
+    r.status = Pipling::Status::Dropped;
+    s = to_string(r);
+    CHECK(s.find("Dropped") != std::string::npos);
+    CHECK(s.find("MST weight:") == std::string::npos);
+    CHECK(s.back() == '}');
+
+    r.status = Pipling::Status::TimedOut;
+    s = to_string(r);
+    CHECK(s.find("Timed out, partial results:\nMST weight:\n7") != std::string::npos);
 }
 
 // choice==1 — manual graph; read until '}'
@@ -174,6 +186,141 @@ TEST_CASE("my_handler: choice=2 (random graph) produces a delimited response") {
     CHECK(resp.find("max flow:") != std::string::npos);
 }
 
+// choice==3 — manual graph followed by max flow pairs
+TEST_CASE("my_handler: choice=3 (graph + flow pairs) reports every pair") {
+    ignore_sigpipe_once();
+    int sp[2]; REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+    int srv = sp[0], cli = sp[1];
+
+    std::thread t([&]{ CHECK(my_handler(srv) == true); });
+
+    send_int(cli, 3);
+    send_int(cli, 3);
+    send_int(cli, 0); send_int(cli, 1);
+    send_int(cli, 1); send_int(cli, 2);
+    send_int(cli, -1); send_int(cli, -1);
+    send_int(cli, 2); // pairs
+    send_int(cli, 0); send_int(cli, 2);
+    send_int(cli, 2); send_int(cli, 0);
+
+    std::string resp;
+    REQUIRE(read_until_delim(cli, '}', resp));
+    ::close(cli);
+    t.join();
+
+    CHECK(resp.find("0->2: 1") != std::string::npos);
+    CHECK(resp.find("2->0: 0") != std::string::npos);
+}
+
+// Concurrent connections feed the one shared pipeline and each gets its own answer
+TEST_CASE("my_handler: concurrent clients receive their own results") {
+    ignore_sigpipe_once();
+    const int clients = 4;
+    std::vector<std::string> resp(clients);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            int sp[2]; REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+            int srv = sp[0], cli = sp[1];
+            std::thread t([&]{ CHECK(my_handler(srv) == true); });
+            send_int(cli, 3); // Path 0 -> 1 -> ... -> c + 1, flow asked for 0 -> c + 1 and back
+            send_int(cli, c + 2);
+            for (int v = 0; v <= c; ++v) { send_int(cli, v); send_int(cli, v + 1); }
+            send_int(cli, -1); send_int(cli, -1);
+            send_int(cli, 2);
+            send_int(cli, 0); send_int(cli, c + 1);
+            send_int(cli, c + 1); send_int(cli, 0);
+            CHECK(read_until_delim(cli, '}', resp[c]));
+            ::close(cli);
+            t.join();
+            ::close(srv);
+        });
+    }
+    for (auto& t : threads) t.join();
+    for (int c = 0; c < clients; ++c) {
+        CHECK(resp[c].find("0->" + std::to_string(c + 1) + ": 1") != std::string::npos);
+        CHECK(resp[c].find(std::to_string(c + 1) + "->0: 0") != std::string::npos);
+    }
+}
+
+// choice==5 — graph file on the server's disk, then max flow pairs
+TEST_CASE("my_handler: choice=5 (graph file) maps the file and reports the pairs") {
+    ignore_sigpipe_once();
+    Graph g(4, true);
+    g.addEdge(0,1); g.addEdge(1,3); g.addEdge(0,2); g.addEdge(2,3);
+    std::string path = "test_server_graph.csr";
+    writeGraphFile(path, g);
+    ::setenv("PIPLING_DATA_DIR", ".", 1); // Names are resolved in the data directory
+
+    int sp[2]; REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+    int srv = sp[0], cli = sp[1];
+
+    std::thread t([&]{ CHECK(my_handler(srv) == true); });
+
+    send_int(cli, 5);
+    send_int(cli, (int)path.size());
+    REQUIRE(::write(cli, path.data(), path.size()) == (ssize_t)path.size());
+    send_int(cli, 2); // pairs
+    send_int(cli, 0); send_int(cli, 3);
+    send_int(cli, 1); send_int(cli, 3);
+
+    std::string resp;
+    REQUIRE(read_until_delim(cli, '}', resp));
+    ::close(cli);
+    t.join();
+    ::unlink(path.c_str());
+
+    CHECK(resp.find("0->3: 2") != std::string::npos);
+    CHECK(resp.find("1->3: 1") != std::string::npos);
+}
+
+// choice==5 — names outside the data directory, or not naming a regular file, are refused before anything is opened
+TEST_CASE("my_handler: choice=5 only reads regular files inside the data directory") {
+    REQUIRE(::mkdir("test_server_data", 0755) == 0);
+    std::string inside = "test_server_data/g.csr", outside = "test_server_outside.csr";
+    Graph g(2, true);
+    g.addEdge(0, 1);
+    writeGraphFile(inside, g);
+    writeGraphFile(outside, g);
+    REQUIRE(::mkdir("test_server_data/sub", 0755) == 0);
+    REQUIRE(::symlink("../test_server_outside.csr", "test_server_data/link.csr") == 0);
+    REQUIRE(::symlink("..", "test_server_data/up") == 0);
+    REQUIRE(::symlink("g.csr", "test_server_data/alias.csr") == 0);
+    ::setenv("PIPLING_DATA_DIR", "test_server_data", 1);
+
+    auto request = [](const std::string& name) {
+        int sp[2];
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+        send_int(sp[1], 5);
+        send_int(sp[1], (int)name.size());
+        REQUIRE(::write(sp[1], name.data(), name.size()) == (ssize_t)name.size());
+        send_int(sp[1], 0); // no pairs
+        bool refused = false;
+        try { my_handler(sp[0]); } catch (const std::invalid_argument&) { refused = true; }
+        ::close(sp[0]);
+        ::close(sp[1]);
+        return refused;
+    };
+    CHECK(request("../test_server_outside.csr"));
+    CHECK(request("sub/../../test_server_outside.csr"));
+    CHECK(request("/etc/passwd"));
+    CHECK(request("sub")); // Directory
+    CHECK(request("link.csr")); // Symbolic link out of the directory
+    CHECK(request("up/test_server_outside.csr")); // Through a symbolically linked directory
+    CHECK_FALSE(request("alias.csr")); // A link that stays inside is fine
+    CHECK(request("missing.csr"));
+    CHECK_FALSE(request("g.csr"));
+
+    ::unlink("test_server_data/link.csr");
+    ::unlink("test_server_data/up");
+    ::unlink("test_server_data/alias.csr");
+    ::rmdir("test_server_data/sub");
+    ::unlink(inside.c_str());
+    ::rmdir("test_server_data");
+    ::unlink(outside.c_str());
+    ::setenv("PIPLING_DATA_DIR", ".", 1);
+}
+
 // choice==0 — no work
 TEST_CASE("my_handler: choice=0 returns false (no work)") {
     int sp[2]; REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
@@ -187,6 +334,110 @@ TEST_CASE("my_handler: choice=0 returns false (no work)") {
 }
 
 // invalid choice — throws
+TEST_CASE("my_handler: choice=6 (graph + flow pairs + mask) answers only the chosen algorithms") {
+    ignore_sigpipe_once();
+    int sp[2]; REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+    int srv = sp[0], cli = sp[1];
+
+    std::thread t([&]{ CHECK(my_handler(srv) == true); });
+
+    send_int(cli, 6);
+    send_int(cli, 3);
+    send_int(cli, 0); send_int(cli, 1);
+    send_int(cli, 1); send_int(cli, 2);
+    send_int(cli, -1); send_int(cli, -1);
+    send_int(cli, 1); // pairs
+    send_int(cli, 0); send_int(cli, 2);
+    send_int(cli, 4 | 8); // SCCs and max flow
+
+    std::string resp;
+    REQUIRE(read_until_delim(cli, '}', resp));
+    ::close(cli);
+    t.join();
+
+    CHECK(resp.find("Strongly Connected Components") != std::string::npos);
+    CHECK(resp.find("max flow:\n1") != std::string::npos);
+    CHECK(resp.find("MST weight") == std::string::npos);
+    CHECK(resp.find("number of cliques") == std::string::npos);
+}
+
+// A client that hangs up while its clique count runs cancels the job instead of leaving it on the stage for hours
+TEST_CASE("my_handler: client disconnect cancels its job") {
+    ignore_sigpipe_once();
+    int sp[2]; REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+    int srv = sp[0], cli = sp[1];
+
+    std::thread t([&]{ CHECK(my_handler(srv) == true); });
+
+    send_int(cli, 7); // Random graph, pairs, mask
+    send_int(cli, 40); send_int(cli, 780); send_int(cli, 1); // Complete graph K40, 2^40 - 1 cliques
+    send_int(cli, 0); // Default pair
+    send_int(cli, 2); // Cliques only
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto closed = std::chrono::steady_clock::now();
+    ::close(cli);
+    t.join();
+    ::close(srv);
+    CHECK(std::chrono::steady_clock::now() - closed < std::chrono::seconds(5));
+}
+
+// A client may shutdown(SHUT_WR) once its request is out: end of input alone isn't a hang-up, it still gets the answer
+TEST_CASE("my_handler: a half-closed client is not cancelled and gets its whole answer") {
+    ignore_sigpipe_once();
+    int sp[2]; REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
+    int srv = sp[0], cli = sp[1];
+
+    std::thread t([&]{ CHECK(my_handler(srv) == true); });
+
+    const int n = 23; // Long enough for the handler to look at the socket a few times
+    send_int(cli, 7); // Random graph, pairs, mask
+    send_int(cli, n); send_int(cli, n * (n - 1) / 2); send_int(cli, 1); // Complete graph
+    send_int(cli, 0); // Default pair
+    send_int(cli, 2); // Cliques only
+    ::shutdown(cli, SHUT_WR);
+
+    std::string resp;
+    REQUIRE(read_until_delim(cli, '}', resp));
+    t.join();
+    ::close(cli);
+    ::close(srv);
+    CHECK(resp.find("Cancelled") == std::string::npos);
+    CHECK(resp.find("number of cliques:\n" + std::to_string((1ull << n) - 1)) != std::string::npos);
+    CHECK(resp.rfind("\nnumber", 0) == 0); // The leading newline once, sent ahead or not
+}
+
+// Over TCP a full close looks like a half-close until the server writes: the probe it sends draws a reset
+TEST_CASE("my_handler: a TCP client that closes its socket cancels its job") {
+    ignore_sigpipe_once();
+    int port = find_free_port();
+    std::thread client([&]{
+        int c = ::socket(AF_INET, SOCK_STREAM, 0);
+        REQUIRE(c >= 0);
+        sockaddr_in sa{};
+        sa.sin_family = AF_INET;
+        sa.sin_port   = htons((uint16_t)port);
+        inet_pton(AF_INET, "127.0.0.1", &sa.sin_addr);
+        for (int i = 0; i < 100; i++) {
+            if (::connect(c, (sockaddr*)&sa, sizeof(sa)) == 0) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        send_int(c, 7);
+        send_int(c, 40); send_int(c, 780); send_int(c, 1); // Complete graph K40, 2^40 - 1 cliques
+        send_int(c, 0);
+        send_int(c, 2);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        ::close(c);
+    });
+
+    int fd = bind_listen(port);
+    REQUIRE(fd >= 0);
+    auto start = std::chrono::steady_clock::now();
+    CHECK(my_handler(fd) == true);
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    ::close(fd);
+    client.join();
+}
+
 TEST_CASE("my_handler: invalid choice throws invalid_argument") {
     int sp[2]; REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM, 0, sp) == 0);
     int srv = sp[0], cli = sp[1];
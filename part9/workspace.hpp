@@ -0,0 +1,57 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <memory>
+
+// Residual network in CSR form: arcs leaving u are [offset[u], offset[u+1]),
+// head[a] is the arc target and rev[a] the index of its paired reverse arc.
+struct FlowNetwork {
+    int n = 0;
+    std::vector<int> offset, head, rev;
+    std::vector<int> baseCap; // Capacities before any flow is pushed
+    std::vector<int> fill; // Next free arc slot per vertex while building
+};
+
+// Scratch memory for Graph algorithms. Buffers only grow, and the visited set is an epoch stamp,
+// so starting a traversal is O(1) and repeated calls through the same Workspace allocate nothing
+// beyond their results (and, for a multi-threaded maxFlows, its threads). Not thread-safe: every
+// thread keeps its own (one per pipeline stage; Graph falls back to a thread_local one when no
+// Workspace is passed).
+class Workspace {
+public:
+    // Start a traversal over n vertices: every vertex becomes unvisited
+    void begin(int n) {
+        if ((int)mark.size() < n) mark.resize(n, 0);
+        if (++epoch == 0) { // Wrapped around: old stamps could collide
+            std::fill(mark.begin(), mark.end(), 0);
+            epoch = 1;
+        }
+    }
+    bool visited(int v) const { return mark[v] == epoch; }
+    void visit(int v) { mark[v] = epoch; }
+
+    // Grow the buffers a flow query over 'net' needs, so the query itself doesn't allocate
+    void reserveFlow(const FlowNetwork& net) {
+        if ((int)mark.size() < net.n) mark.resize(net.n, 0);
+        parentArc.reserve(net.n);
+        queue.reserve(net.n);
+        cap.reserve(net.baseCap.size());
+    }
+
+    std::vector<std::pair<int, const int*>> frames; // DFS stack: (vertex, next neighbor to try)
+    std::vector<int> order; // DFS finishing order
+    std::vector<int> queue; // BFS queue (index based, never popped)
+    std::vector<int> parentArc; // BFS tree of max flow: arc used to reach each visited vertex
+    std::vector<int> minEdge; // Prim's cheapest edge into the tree
+    std::vector<int> components; // Union-find while connectivity is recomputed
+    std::vector<int> revOffset, revTarget; // Reversed graph as CSR
+    FlowNetwork flow; // Residual network shared by the flow queries of one call
+    std::vector<int> cap; // Residual capacities of the current flow query
+    // Workspaces of the helper threads of a multi-threaded call (maxFlows), kept for the next call
+    std::vector<std::unique_ptr<Workspace>> helpers;
+
+private:
+    std::vector<unsigned> mark; // mark[v] == epoch means v was visited in the current traversal
+    unsigned epoch = 0;
+};